@@ -0,0 +1,121 @@
+# Embeds the shaders under SHADER_DIR into OUTPUT, a C++ header of constexpr
+# strings read by src/core/ShaderLibrary.h. Run in script mode:
+#
+#   cmake -DSHADER_DIR=<repo>/shaders -DOUTPUT=<build>/generated/EmbeddedShaders.h
+#         -P cmake/EmbedShaders.cmake
+#
+# Every *.comp, *.vert and *.frag becomes one entry, keyed by its path from
+# the project root ("shaders/smoke/Raymarch.comp"), with its #includes
+# resolved the same way ShaderLibrary does at run time:
+#   - `#include "file"` on its own line, relative to the including file;
+#   - each file is pasted once per shader, later includes of it are dropped;
+#   - a missing file or an include cycle stops the build.
+# *.glsl files are only included, never embedded on their own.
+
+cmake_minimum_required(VERSION 3.20)
+
+if(NOT SHADER_DIR OR NOT OUTPUT)
+    message(FATAL_ERROR "EmbedShaders.cmake: set SHADER_DIR and OUTPUT")
+endif()
+
+# MSVC caps a single string literal at 16K characters, so sources are split
+# into adjacent raw literals.
+set(CHUNK 8000)
+
+# Appends the flattened text of `path` to the variable `out` (in the caller).
+# `EMBED_SEEN` holds the files already pasted into the current shader,
+# `EMBED_STACK` the chain of files being included (for cycles).
+function(resolve_includes path out)
+    get_filename_component(path "${path}" ABSOLUTE)
+    if(path IN_LIST EMBED_STACK)
+        message(FATAL_ERROR "EmbedShaders: include cycle at ${path}")
+    endif()
+    if(path IN_LIST EMBED_SEEN)
+        set(${out} "" PARENT_SCOPE)
+        return()
+    endif()
+    if(NOT EXISTS "${path}")
+        message(FATAL_ERROR "EmbedShaders: cannot open ${path}")
+    endif()
+    list(APPEND EMBED_SEEN "${path}")
+    list(APPEND EMBED_STACK "${path}")
+
+    file(READ "${path}" text)
+    string(REPLACE "\r" "" text "${text}")
+    get_filename_component(dir "${path}" DIRECTORY)
+
+    # Include directives at the start of a line (after optional blanks).
+    string(REGEX MATCHALL "(^|\n)[ \t]*#[ \t]*include[ \t]*\"[^\"\n]+\"[^\n]*" directives "${text}")
+    foreach(directive IN LISTS directives)
+        string(REGEX REPLACE "^\n?[ \t]*#[ \t]*include[ \t]*\"([^\"\n]+)\".*$" "\\1" name "${directive}")
+        resolve_includes("${dir}/${name}" included)
+        if(NOT included STREQUAL "" AND NOT included MATCHES "\n$")
+            string(APPEND included "\n")
+        endif()
+        # Splice at the first occurrence only; a repeated directive is
+        # spliced (as nothing) on its own turn of the loop.
+        string(FIND "${text}" "${directive}" at)
+        string(LENGTH "${directive}" len)
+        string(SUBSTRING "${text}" 0 ${at} head)
+        math(EXPR rest "${at} + ${len}")
+        string(SUBSTRING "${text}" ${rest} -1 tail)
+        if(directive MATCHES "^\n")
+            string(APPEND head "\n")
+        endif()
+        # The included text ends in a line break; drop the directive's own.
+        if(NOT included STREQUAL "" AND tail MATCHES "^\n")
+            string(SUBSTRING "${tail}" 1 -1 tail)
+        endif()
+        set(text "${head}${included}${tail}")
+    endforeach()
+
+    set(EMBED_SEEN "${EMBED_SEEN}" PARENT_SCOPE)
+    set(${out} "${text}" PARENT_SCOPE)
+endfunction()
+
+get_filename_component(SHADER_DIR "${SHADER_DIR}" ABSOLUTE)
+get_filename_component(ROOT_DIR "${SHADER_DIR}" DIRECTORY)
+file(GLOB_RECURSE shaders RELATIVE "${ROOT_DIR}"
+    "${SHADER_DIR}/*.comp" "${SHADER_DIR}/*.vert" "${SHADER_DIR}/*.frag")
+list(SORT shaders)
+
+set(header "// Generated by cmake/EmbedShaders.cmake from shaders/ - do not edit.\n")
+string(APPEND header "#pragma once\n\nnamespace EmbeddedShaders {\n\n")
+string(APPEND header "struct File {\n    const char* path;     // from the project root\n")
+string(APPEND header "    const char* source;   // #includes resolved\n};\n\n")
+string(APPEND header "inline constexpr File files[] = {\n")
+
+foreach(shader IN LISTS shaders)
+    set(EMBED_SEEN "")
+    set(EMBED_STACK "")
+    resolve_includes("${ROOT_DIR}/${shader}" source)
+    if(source MATCHES "\\)glsl\"")
+        message(FATAL_ERROR "EmbedShaders: ${shader} contains the raw string delimiter )glsl\"")
+    endif()
+
+    string(APPEND header "    { \"${shader}\",\n")
+    string(LENGTH "${source}" length)
+    set(offset 0)
+    while(offset LESS length)
+        string(SUBSTRING "${source}" ${offset} ${CHUNK} piece)
+        string(APPEND header "      R\"glsl(${piece})glsl\"\n")
+        math(EXPR offset "${offset} + ${CHUNK}")
+    endwhile()
+    if(length EQUAL 0)
+        string(APPEND header "      \"\"\n")
+    endif()
+    string(APPEND header "    },\n")
+endforeach()
+
+string(APPEND header "};\n\n} // namespace EmbeddedShaders\n")
+
+# Only touch the header when it changes, so unchanged shaders rebuild nothing.
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" previous)
+    if(previous STREQUAL header)
+        return()
+    endif()
+endif()
+file(WRITE "${OUTPUT}" "${header}")
+list(LENGTH shaders count)
+message(STATUS "Embedded ${count} shaders in ${OUTPUT}")
@@ -0,0 +1,73 @@
+// Bilateral 2x2 bilinear upsample (Upsampler.h).
+//
+// For each output pixel:
+//   1. Read the farthest linear scene depth under the pixel.
+//   2. Iterate the 2x2 low-res neighbourhood.
+//   3. For each neighbour, read the depth its ray was clipped at
+//      (farthest depth under the low-res texel).
+//   4. Weight = bilinear_weight * exp(-|depth_diff| * sigma).
+//      Neighbours across a depth discontinuity (wall edge) get near-zero weight.
+//   5. Normalise. Fallback to nearest-neighbour if all weights collapse.
+//
+// Result: smoke colour + transmittance alpha are depth-correct at wall edges
+// — no bleeding of smoke across geometry boundaries.
+//
+// No #version line: Upsampler prepends GLSL_VERSION (410 on macOS).
+
+in vec2 texCoord;
+out vec4 fragColor;
+uniform sampler2D u_Tex;
+uniform sampler2D u_DepthPyramid;
+uniform ivec2     u_TexSize;     // valid input sub-rect
+uniform ivec2     u_DstSize;
+uniform int       u_SrcLevel;
+uniform int       u_DstLevel;
+uniform sampler2D u_RefinedTex;  // full-res re-marched edge pixels
+uniform sampler2D u_EdgeFlags;
+uniform int       u_UseRefine;   // final (full-res) pass only
+
+#include "include/DepthFootprint.glsl"
+
+void main() {
+    if (u_UseRefine != 0 && texelFetch(u_EdgeFlags, ivec2(gl_FragCoord.xy), 0).r > 0.5) {
+        fragColor = texelFetch(u_RefinedTex, ivec2(gl_FragCoord.xy), 0);
+        return;
+    }
+
+    float centerDepth = footprintMaxDepth(ivec2(gl_FragCoord.xy), u_DstSize, u_DstLevel);
+
+    vec2  texSize  = vec2(u_TexSize);
+    vec2  pixelPos = texCoord * texSize - 0.5;
+    ivec2 base     = ivec2(floor(pixelPos));
+    vec2  f        = fract(pixelPos);
+
+    vec4  result   = vec4(0.0);
+    float totalW   = 0.0;
+
+    for (int dy = 0; dy <= 1; dy++) {
+        for (int dx = 0; dx <= 1; dx++) {
+            ivec2 texel = clamp(base + ivec2(dx, dy), ivec2(0), u_TexSize - 1);
+
+            float nDepth = footprintMaxDepth(texel, u_TexSize, u_SrcLevel);
+            float depthW = exp(-abs(centerDepth - nDepth) * 100.0);
+
+            float bx = (dx == 0) ? (1.0 - f.x) : f.x;
+            float by = (dy == 0) ? (1.0 - f.y) : f.y;
+            float w  = bx * by * depthW;
+
+            result += texelFetch(u_Tex, texel, 0) * w;
+            totalW += w;
+        }
+    }
+
+    if (totalW < 1e-5) {
+        // All neighbours on the other side of a depth edge — use nearest.
+        ivec2 nearest = clamp(ivec2(round(pixelPos)), ivec2(0), u_TexSize - 1);
+        result = texelFetch(u_Tex, nearest, 0);
+    } else {
+        result /= totalW;
+    }
+
+    result.a = clamp(result.a, 0.0, 1.0);
+    fragColor = result;
+}
@@ -0,0 +1,20 @@
+// Farthest scene depth under pixel p of a size-wide grid covering the
+// screen, from DepthPyramid level `level` (R = min, G = max linear depth),
+// shared by the raymarch, upsample, temporal resolve and edge passes.
+// At power-of-two scales the footprint is exactly one texel of `level`;
+// other scales straddle a few texels and take their max.
+//
+// The including shader declares `uniform sampler2D u_DepthPyramid` first.
+float footprintMaxDepth(ivec2 p, ivec2 size, int level) {
+    vec2  invScale = vec2(textureSize(u_DepthPyramid, 0)) / vec2(size);
+    ivec2 lvlSize  = textureSize(u_DepthPyramid, level);
+    ivec2 fMin = ivec2(floor(vec2(p) * invScale));
+    ivec2 fMax = max(ivec2(ceil(vec2(p + 1) * invScale)) - 1, fMin);
+    ivec2 hMin = clamp(fMin >> level, ivec2(0), lvlSize - 1);
+    ivec2 hMax = clamp(fMax >> level, ivec2(0), lvlSize - 1);
+    float zMax = 0.0;
+    for (int y = hMin.y; y <= hMax.y; y++)
+        for (int x = hMin.x; x <= hMax.x; x++)
+            zMax = max(zMax, texelFetch(u_DepthPyramid, ivec2(x, y), level).g);
+    return zMax;
+}
@@ -0,0 +1,19 @@
+// Cell indexing for the smoke grid (x fastest, then y, then z), shared by
+// the solver, flood-fill, bounds and raymarch kernels.
+//
+// GRID_SIZE is the grid size; SolverParams.glsl sets it (a constant in a
+// specialised variant), anything else falls back to a u_GridSize uniform.
+#ifndef GRID_SIZE
+#define GRID_SIZE u_GridSize
+#endif
+
+int flatIdx(ivec3 c) {
+    return c.x + c.y * GRID_SIZE.x + c.z * GRID_SIZE.x * GRID_SIZE.y;
+}
+
+bool inBounds(ivec3 c) {
+    return c.x >= 0 && c.y >= 0 && c.z >= 0 &&
+           c.x < GRID_SIZE.x &&
+           c.y < GRID_SIZE.y &&
+           c.z < GRID_SIZE.z;
+}
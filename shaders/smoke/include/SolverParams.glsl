@@ -0,0 +1,60 @@
+// Solver parameters (SolverParams.h): one block shared by every solver kernel,
+// uploaded once per step. The layout must match the C++ struct.
+layout(std140, binding = 0) uniform SolverParams {
+    ivec3 u_GridSize;       float u_CellSize;
+    vec3  u_BoundsMin;      float u_Dt;
+    vec3  u_VacuumWorldPos; int   u_VacuumActive;   // vacuum (Shift+RClick)
+    float u_VacuumStrength;
+    float u_VacuumRadius;
+    float u_VacuumPressure;                         // Dirichlet BC at the vacuum voxel
+    float u_VoxelSize;
+    float u_FallOff;
+    float u_CoolingRate;
+    float u_SmokeDiffuseRate;
+    float u_GravityStrength;
+    float u_BuoyancyStrength;                       // legacy density-based mode
+    float u_DensityLow;
+    float u_DensityHigh;
+    float u_TemperatureBuoyancyStrength;            // heat-based mode
+    float u_BaroclinicStrength;
+    int   u_BuoyancyMode;                           // 0 = density-based, 1 = temperature-based
+};
+
+// Specialisation (ShaderVariants.h): SmokeSolver compiles each kernel with
+// the grid size and its toggles as #defines so they fold to constants;
+// without them the block above is read at run time.
+#ifdef SMOKE_GRID_X
+#define GRID_SIZE ivec3(SMOKE_GRID_X, SMOKE_GRID_Y, SMOKE_GRID_Z)
+#else
+#define GRID_SIZE u_GridSize
+#endif
+#ifdef SMOKE_BUOYANCY_MODE
+const int BUOYANCY_MODE = SMOKE_BUOYANCY_MODE;
+#else
+#define BUOYANCY_MODE u_BuoyancyMode
+#endif
+#ifdef SMOKE_VACUUM
+const bool VACUUM_ACTIVE = SMOKE_VACUUM != 0;     // dead code when 0
+#else
+#define VACUUM_ACTIVE (u_VacuumActive == 1)
+#endif
+
+#include "Grid.glsl"
+
+// The including kernel declares its `int walls[]` buffer first.
+bool isFluidCell(ivec3 c) {
+    if (!inBounds(c)) {
+        return false;
+    }
+    return walls[flatIdx(c)] == 0;
+}
+
+vec3 gridToWorldCenter(ivec3 c) {
+    return u_BoundsMin + (vec3(c) + 0.5) * u_CellSize;
+}
+
+// World position to continuous grid coordinates; minus 0.5 because data
+// is stored at cell centres.
+vec3 worldToGridFloat(vec3 p) {
+    return ((p - u_BoundsMin) / u_CellSize) - vec3(0.5);
+}
@@ -0,0 +1,21 @@
+// Trilinear blend of the 8 cell samples around a grid position:
+//   c0 = ivec3(floor(gridPos)), f = fract(gridPos),
+//   s[i] = sample at trilinearCorner(c0, i),
+// interpolated along x, then y, then z.
+ivec3 trilinearCorner(ivec3 c0, int i) {
+    return c0 + ivec3(i & 1, (i >> 1) & 1, i >> 2);
+}
+
+float trilinear(float s[8], vec3 f) {
+    vec4 x = mix(vec4(s[0], s[2], s[4], s[6]), vec4(s[1], s[3], s[5], s[7]), f.x);
+    vec2 y = mix(x.xz, x.yw, f.y);
+    return mix(y.x, y.y, f.z);
+}
+
+vec4 trilinear(vec4 s[8], vec3 f) {
+    vec4 x00 = mix(s[0], s[1], f.x);
+    vec4 x10 = mix(s[2], s[3], f.x);
+    vec4 x01 = mix(s[4], s[5], f.x);
+    vec4 x11 = mix(s[6], s[7], f.x);
+    return mix(mix(x00, x10, f.y), mix(x01, x11, f.y), f.z);
+}
@@ -0,0 +1,73 @@
+#ifndef GPU_PROFILER_OVERLAY_H
+#define GPU_PROFILER_OVERLAY_H
+
+#include "imgui.h"
+#include "core/GpuProfiler.h"
+#include "core/FrameTrace.h"
+
+// ImGui window with the per-pass GPU breakdown from GpuProfiler and the
+// FrameTrace capture button. Toggle with `enabled` (P key). Bars are
+// relative to the frame total.
+struct GpuProfilerOverlay {
+    bool        enabled = false;
+    const char* csvPath = "gpu_profile.csv";
+
+    void draw() {
+        if (!enabled) return;
+        GpuProfiler& profiler = GpuProfiler::instance();
+
+        ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+        ImGui::Begin("GPU Profiler", &enabled, ImGuiWindowFlags_AlwaysAutoResize);
+
+        ImGui::Checkbox("Enabled", &profiler.enabled);
+        float total = profiler.lastFrameTotalMs();
+        ImGui::Text("Timed passes: %.2f ms   skipped frames: %llu",
+                    total, (unsigned long long)profiler.skippedFrames());
+
+        if (ImGui::BeginTable("passes", 4)) {
+            ImGui::TableSetupColumn("Pass");
+            ImGui::TableSetupColumn("Last ms");
+            ImGui::TableSetupColumn("Avg ms");
+            ImGui::TableSetupColumn("Share");
+            ImGui::TableHeadersRow();
+            for (const GpuProfiler::PassStats& s : profiler.stats()) {
+                bool stale = s.lastFrame != profiler.resolvedFrameIndex();
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                if (stale) ImGui::TextDisabled("%s", s.name.c_str());
+                else       ImGui::Text("%s", s.name.c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", stale ? 0.0f : s.lastMs);
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", s.avgMs);
+                ImGui::TableNextColumn();
+                ImGui::ProgressBar(stale || total <= 0.0f ? 0.0f : s.lastMs / total, ImVec2(120, 0));
+            }
+            ImGui::EndTable();
+        }
+
+        ImGui::Separator();
+        if (ImGui::Checkbox("Record", &profiler.recording) && profiler.recording)
+            profiler.clearRecording();
+        ImGui::SameLine();
+        ImGui::Text("%zu rows", profiler.recordedRows());
+        if (ImGui::Button("Export CSV")) profiler.exportCSV(csvPath);
+        ImGui::SameLine();
+        if (ImGui::Button("Clear")) profiler.clearRecording();
+
+        ImGui::Separator();
+        FrameTrace& trace = FrameTrace::instance();
+        if (trace.capturing()) {
+            ImGui::Text("Capturing trace... %d / %d frames",
+                        trace.framesCaptured(), trace.captureFrames);
+        } else {
+            ImGui::SetNextItemWidth(100);
+            ImGui::SliderInt("Frames", &trace.captureFrames, 1, 120);
+            ImGui::SameLine();
+            if (ImGui::Button("Capture Trace")) trace.start(trace.captureFrames);
+            ImGui::TextDisabled("Writes %s (open in Perfetto)", trace.path.c_str());
+        }
+
+        ImGui::End();
+    }
+};
+
+#endif
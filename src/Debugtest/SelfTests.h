@@ -9,6 +9,7 @@
 
 #include "core/ComputeShader.h"
 #include "core/Buffer.h"
+#include "core/AsyncReadback.h"
 #include "core/Texture3D.h"
 
 // GPU self-tests run once at startup to verify the compute pipeline works.
@@ -117,10 +118,48 @@ inline bool testTexture3DRoundTrip() {
     return pass;
 }
 
+// Verifies the fenced AsyncReadback path returns what a compute pass wrote.
+inline bool testAsyncReadback() {
+    const char* src =
+        "#version 430 core\n"
+        "layout(local_size_x = 64) in;\n"
+        "layout(std430, binding = 0) buffer OutBuf { int data[]; };\n"
+        "void main() {\n"
+        "    uint i = gl_GlobalInvocationID.x;\n"
+        "    data[i] = int(i) * 3 + 1;\n"
+        "}\n";
+
+    ComputeShader cs;
+    cs.setUp(src);
+
+    const int N = 256;
+    SSBOBuffer buf;
+    buf.allocate(N * sizeof(int));
+    buf.bindBase(0);
+    cs.dispatch(N);
+
+    AsyncReadback readback;
+    readback.request(buf, N * sizeof(int));
+    bool pass = readback.wait();
+    if (pass) {
+        const int* result = readback.data<int>();
+        for (int i = 0; i < N; i++)
+            if (result[i] != i * 3 + 1) { pass = false; break; }
+    }
+
+    readback.destroy();
+    buf.destroy();
+    glDeleteProgram(cs.ID);
+
+    std::cout << "  Async readback:    " << (pass ? "PASSED" : "FAILED") << "\n";
+    return pass;
+}
+
 inline void runAllTests() {
     std::cout << "[SelfTests]\n";
     testComputeSSBO();
     testTexture3DRoundTrip();
+    testAsyncReadback();
     std::cout << std::endl;
 }
 
@@ -0,0 +1,66 @@
+#ifndef STEPS_HEATMAP_VIEW_H
+#define STEPS_HEATMAP_VIEW_H
+
+#include "core/shader.h"
+#include "core/Texture2D.h"
+#include "core/FullscreenQuad.h"
+#include "glVersion.h"
+
+// Draws the raymarch "fine steps per ray" image (ShaderStats::stepsImage)
+// as a blue -> green -> red heatmap, red at `maxSteps` and above.
+// Only has data in SMOKE_STATS builds. Toggle with `enabled`.
+struct StepsHeatmapView {
+    bool enabled  = false;
+    int  maxSteps = 256;
+
+    void init() {
+        const char* vs = GLSL_VERSION
+            "layout(location=0) in vec2 aPos;\n"
+            "layout(location=1) in vec2 aUV;\n"
+            "out vec2 vUV;\n"
+            "void main() { gl_Position = vec4(aPos,0,1); vUV = aUV; }\n";
+
+        const char* fs = GLSL_VERSION
+            "in vec2 vUV;\n"
+            "out vec4 FragColor;\n"
+            "uniform usampler2D u_StepsTex;\n"
+            "uniform ivec2 u_Size;\n"       // valid sub-rect (raymarch render size)
+            "uniform float u_MaxSteps;\n"
+            "\n"
+            "vec3 heat(float x) {\n"
+            "    x = clamp(x, 0.0, 1.0);\n"
+            "    vec3 cold = mix(vec3(0.0, 0.0, 0.3), vec3(0.0, 0.8, 0.2), clamp(x * 2.0, 0.0, 1.0));\n"
+            "    return mix(cold, vec3(1.0, 0.1, 0.0), clamp(x * 2.0 - 1.0, 0.0, 1.0));\n"
+            "}\n"
+            "\n"
+            "void main() {\n"
+            "    ivec2 p = clamp(ivec2(vUV * vec2(u_Size)), ivec2(0), u_Size - 1);\n"
+            "    uint  steps = texelFetch(u_StepsTex, p, 0).r;\n"
+            "    FragColor = steps == 0u ? vec4(0.0, 0.0, 0.0, 1.0)\n"
+            "                            : vec4(heat(float(steps) / u_MaxSteps), 1.0);\n"
+            "}\n";
+
+        visShader.setUpShader(vs, fs);
+    }
+
+    // Call inside the render loop when enabled. w, h: raymarch render size.
+    void draw(Texture2D& stepsTex, int w, int h, FullscreenQuad& quad) {
+        glDisable(GL_DEPTH_TEST);
+        visShader.use();
+        visShader.setInt  ("u_StepsTex", 0);
+        visShader.setFloat("u_MaxSteps", (float)maxSteps);
+        glUniform2i(glGetUniformLocation(visShader.ID, "u_Size"), w, h);
+        stepsTex.bindSampler(0);
+        quad.draw();
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    void destroy() {
+        glDeleteProgram(visShader.ID);
+    }
+
+private:
+    shader visShader;
+};
+
+#endif // STEPS_HEATMAP_VIEW_H
@@ -49,7 +49,7 @@ public:
         pongBuf.clear();
 
         seedCS.setUp(getSeedSource());
-        fillCS.setUp(getFillSource());
+        fillCS.setUpFromFile("shaders/smoke/FloodFill.comp");
     }
 
     void seed(glm::vec3 worldPos, glm::ivec3 gridSize,
@@ -75,8 +75,7 @@ public:
         std::cout << "Flood fill seeded at grid ("
                   << coord.x << ", "
                   << coord.y << ", "
-                  << coord.z << ")"
-                  << std::endl;
+                  << coord.z << ")\n";
     }
 
     void propagate(int steps,
@@ -172,80 +171,6 @@ void main() {
     data[u_SeedIdx] = max(data[u_SeedIdx], u_SeedVal);
 }
 )";
-return src.c_str();
-    }
-
-    const char* getFillSource() {
-    static string src = string(GLSL_VERSION_CORE) + R"(
-layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
-
-layout(std430, binding = 0) readonly buffer WallBuf { int walls[]; };
-layout(std430, binding = 1) readonly buffer SrcBuf  { int src[]; };
-layout(std430, binding = 2) writeonly buffer DstBuf { int dst[]; };
-
-uniform ivec3 u_GridSize;
-uniform ivec3 u_SeedCoord;
-uniform int   u_MaxSeedVal;   // current unscaled radius (grows 1..maxSeedValue)
-uniform float u_RadiusXZ;
-uniform float u_RadiusY;
-
-int flatIdx(ivec3 c) {
-    return c.x + c.y * u_GridSize.x + c.z * u_GridSize.x * u_GridSize.y;
-}
-
-void main() {
-
-    ivec3 coord = ivec3(gl_GlobalInvocationID);
-    if (any(greaterThanEqual(coord, u_GridSize))) return;
-
-    int idx = flatIdx(coord);
-
-    if (walls[idx] != 0) { dst[idx] = 0; return; }
-
-    // ---- Flood-fill connectivity (uniform step cost = 1, large budget) ----
-    // The budget always exceeds the ellipsoid semi-axis so in open space the
-    // wavefront always reaches the boundary.  maxVal > 0 means this voxel is
-    // reachable from the seed without passing through a wall.
-    int maxVal = src[idx];
-    ivec3 nc; int nIdx;
-
-    nc = coord + ivec3(-1,0,0);
-    if (nc.x >= 0)            { nIdx = flatIdx(nc); if (walls[nIdx] == 0) maxVal = max(maxVal, src[nIdx] - 1); }
-
-    nc = coord + ivec3(1,0,0);
-    if (nc.x < u_GridSize.x)  { nIdx = flatIdx(nc); if (walls[nIdx] == 0) maxVal = max(maxVal, src[nIdx] - 1); }
-
-    nc = coord + ivec3(0,-1,0);
-    if (nc.y >= 0)            { nIdx = flatIdx(nc); if (walls[nIdx] == 0) maxVal = max(maxVal, src[nIdx] - 1); }
-
-    nc = coord + ivec3(0,1,0);
-    if (nc.y < u_GridSize.y)  { nIdx = flatIdx(nc); if (walls[nIdx] == 0) maxVal = max(maxVal, src[nIdx] - 1); }
-
-    nc = coord + ivec3(0,0,-1);
-    if (nc.z >= 0)            { nIdx = flatIdx(nc); if (walls[nIdx] == 0) maxVal = max(maxVal, src[nIdx] - 1); }
-
-    nc = coord + ivec3(0,0,1);
-    if (nc.z < u_GridSize.z)  { nIdx = flatIdx(nc); if (walls[nIdx] == 0) maxVal = max(maxVal, src[nIdx] - 1); }
-
-    // Not reachable from seed
-    if (maxVal <= 0) { dst[idx] = 0; return; }
-
-    // ---- Ellipsoid hard boundary ----
-    // Voxels outside the current growing ellipsoid are zeroed.
-    // The smooth density gradient is computed in the raymarcher using the
-    // seed world position and ellipsoid parameters, avoiding the L1 diamond
-    // artifact that would result from using the flood-fill budget directly.
-    vec3 diff = vec3(coord - u_SeedCoord);
-    float ex = diff.x / (float(u_MaxSeedVal) * u_RadiusXZ);
-    float ey = diff.y / (float(u_MaxSeedVal) * u_RadiusY);
-    float ez = diff.z / (float(u_MaxSeedVal) * u_RadiusXZ);
-    if (ex*ex + ey*ey + ez*ez > 1.0) { dst[idx] = 0; return; }
-
-    // Store the flood-fill budget so it propagates correctly in future steps.
-    // The raymarch shader converts this to a smooth ellipsoid density.
-    dst[idx] = max(0, maxVal);
-}
-)";
 return src.c_str();
     }
 };
@@ -23,11 +23,14 @@ void FloodFillToSmoke::injectSmoke(
     srcSmokeDensityBuf.bindBase(2);
     destSmokeDensityBuf.bindBase(3);
 
+    SmokeInjectParams params;
+    params.gridSize        = domain.gridSize;
+    params.floodFillRadius = floodFillRadius;
+    params.seedCoord       = seedCoord;
+    params.injectStrength  = smokeDenseInjectStrength_;
+    UniformBlock::bind(params);
+
     smokeFillShader_.use();
-    smokeFillShader_.setIVec3("u_GridSize", domain.gridSize);
-    smokeFillShader_.setInt("u_FloodFillRadius", floodFillRadius);
-    smokeFillShader_.setIVec3("u_SeedCoord", seedCoord);
-    smokeFillShader_.setFloat("u_InjectStrength", smokeDenseInjectStrength_);
 
     smokeFillShader_.dispatch(domain.gridSize.x, domain.gridSize.y, domain.gridSize.z);
 
@@ -67,13 +70,16 @@ void FloodFillToSmoke::injectVelocity(
     srcVelocityBuf.bindBase(2);
     destVelocityBuf.bindBase(3);
 
+    VelocityInjectParams params;
+    params.gridSize           = domain.gridSize;
+    params.floodFillRadius    = floodFillRadius;
+    params.seedCoord          = seedCoord;
+    params.floodFillMaxValue  = floodFillMaxValue;
+    params.injectStrength     = velocityInjectStrength_;
+    params.tempInjectStrength = tempInjectStrenth_;
+    UniformBlock::bind(params);
+
     velocityFillShader_.use();
-    velocityFillShader_.setIVec3("u_GridSize", domain.gridSize);
-    velocityFillShader_.setInt("u_FloodFillMaxValue", floodFillMaxValue);
-    velocityFillShader_.setInt("u_FloodFillRadius", floodFillRadius);
-    velocityFillShader_.setIVec3("u_SeedCoord", seedCoord);
-    velocityFillShader_.setFloat("u_InjectStrength", velocityInjectStrength_);
-    velocityFillShader_.setFloat("u_TempInjectStrength", tempInjectStrenth_);
 
     velocityFillShader_.dispatch(domain.gridSize.x, domain.gridSize.y, domain.gridSize.z);
 
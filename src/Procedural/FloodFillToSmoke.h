@@ -3,6 +3,7 @@
 #include "core/Buffer.h"
 #include "core/ComputeShader.h"
 #include "Voxel/VoxelDomain.h"
+#include "core/UniformBlock.h"
 
 constexpr float DEFAULT_VELOCITY_INJECT_STRENGTH = 0.1f;
 constexpr float DEFAULT_SMOKEDENSE_INJECT_STRENGTH = 0.8f;
@@ -18,6 +19,19 @@ constexpr float DEFAULT_SMOKETEMP_INJECT_STRENTH = 30.0f;
 */
 class FloodFillToSmoke {
 public:
+    // std140 mirrors of the two shaders' parameter blocks
+    struct SmokeInjectParams {
+        glm::ivec3 gridSize{0};  int   floodFillRadius = 0;
+        glm::ivec3 seedCoord{0}; float injectStrength  = 0.0f;
+    };
+    struct VelocityInjectParams {
+        glm::ivec3 gridSize{0};  int   floodFillRadius   = 0;
+        glm::ivec3 seedCoord{0}; int   floodFillMaxValue = 0;
+        float injectStrength     = 0.0f;
+        float tempInjectStrength = 0.0f;
+        float pad0_ = 0.0f, pad1_ = 0.0f;
+    };
+
     void init();
     void injectSmoke(
         const SSBOBuffer& floodFillBuf,
@@ -60,4 +74,14 @@ public:
 private:
     ComputeShader smokeFillShader_;
     ComputeShader velocityFillShader_;
-};
\ No newline at end of file
+};
+
+STD140_OFFSET(FloodFillToSmoke::SmokeInjectParams, floodFillRadius, 12);
+STD140_OFFSET(FloodFillToSmoke::SmokeInjectParams, seedCoord,       16);
+STD140_OFFSET(FloodFillToSmoke::SmokeInjectParams, injectStrength,  28);
+STD140_SIZE(FloodFillToSmoke::SmokeInjectParams, 32);
+
+STD140_OFFSET(FloodFillToSmoke::VelocityInjectParams, seedCoord,         16);
+STD140_OFFSET(FloodFillToSmoke::VelocityInjectParams, floodFillMaxValue, 28);
+STD140_OFFSET(FloodFillToSmoke::VelocityInjectParams, injectStrength,    32);
+STD140_SIZE(FloodFillToSmoke::VelocityInjectParams, 48);
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ProceduralSmokeSystem.h"
+#include "core/GpuProfiler.h"
 
 void ProceduralSmokeSystem::init() {
     floodFillToSmoke_.init();
@@ -13,10 +14,13 @@ void ProceduralSmokeSystem::update(
         float dt
     ) {
     
+    CpuTraceScope trace("ProceduralSmokeSystem::update");
     if (dt <= 0.0f) return;
 
     // Step 1: Expand and seed the smoke source region
     // We might have to modify floodfill to accept a tunable dissipation factor so the "smoke" eventually stops being generated
+    GpuProfiler& profiler = GpuProfiler::instance();
+    profiler.begin("Flood Fill");
     floodFill.propagate(
         floodFillStepsPerFrame_,
         domain.gridSize,
@@ -25,8 +29,10 @@ void ProceduralSmokeSystem::update(
         wallBuf,
         dt
     );
+    profiler.end();
 
     // Step 2: Inject floodfill source into smoke scalar field (Density buffer)
+    profiler.begin("Inject");
     floodFillToSmoke_.injectAll(
         floodFill.currentBuffer(),
         floodFill.effectiveMaxDensity(),
@@ -40,6 +46,7 @@ void ProceduralSmokeSystem::update(
         wallBuf,
         floodFill.elapsedTime
     );
+    profiler.end();
     smoke.swapVelocity();
     smoke.swapDensity();
 
@@ -1,30 +1,50 @@
 #ifndef WORLEY_NOISE_H
 #define WORLEY_NOISE_H
 
+#include <algorithm>
+#include <utility>
+
 #include "core/ComputeShader.h"
 #include "core/Texture3D.h"
 #include "glVersion.h"
 
+// Tileable Perlin-Worley fBm volume sampled by the raymarcher.
+//
+// The volume is generated once and kept static: all visible animation comes
+// from the time-dependent UVW offsets in Raymarch.comp, so rebuilding 128^3
+// voxels every frame bought nothing. The wrap mode is GL_REPEAT so the
+// raymarcher's fract() lookups stay seamless at the tile border.
+//
+// Optional evolve mode: the cell layout itself changes over time at ~1/N
+// of the full generation cost. Each cycle builds a volume with a new hash
+// seed, 1/slicesPerCycle of its Z slabs per frame, while the raymarcher
+// crossfades from `texture` to nextTexture() by blend(), the cycle's
+// progress. When the build completes the volumes rotate (next becomes
+// current, the new one becomes next) and blend() restarts from 0, which
+// shows exactly what blend 1 showed, so there is no pop.
 class WorleyNoise {
 public:
-    Texture3D texture;
+    Texture3D texture;       // current volume — always complete, safe to sample
     int resolution = 128;
 
+    bool  evolve         = false;  // time-sliced rebuild with a new seed per cycle
+    int   slicesPerCycle = 16;     // frames per evolve cycle
+
     void init(int res = 128) {
         resolution = res;
-        texture.create(res, res, res, GL_R16F);
+        createVolume(texture);
 
         const char* src = GLSL_VERSION_CORE 
         R"(
 layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
 layout(binding = 0, r16f) uniform image3D u_Output;
 
-uniform float u_Time;
+uniform int   u_Seed;         // evolve cycle; 0 = the static volume
 uniform int   u_Resolution;
 uniform int   u_CellCount;    // number of cells per axis (e.g. 4)
 uniform int   u_Octaves;      // fBm octaves (e.g. 3)
 uniform float u_Persistence;  // amplitude decay per octave (e.g. 0.5)
-uniform float u_Speed;        // animation speed
+uniform int   u_SlabOffset;   // first Z slice written by this dispatch
 
 // Hugo Elias integer hash
 float hash(int n) {
@@ -36,14 +56,14 @@ float hash(int n) {
 // 3D hash -> vec3 in [0,1], tiled at 'wrap' cells
 vec3 hashCell(ivec3 c, int wrap) {
     c = ((c % wrap) + wrap) % wrap;
-    int n = c.x + c.y * 137 + c.z * 7919;
+    int n = c.x + c.y * 137 + c.z * 7919 + u_Seed * 104729;
     return vec3(hash(n), hash(n + 1), hash(n + 2));
 }
 
 // Perlin gradient hash -> unit vec3 gradient
 vec3 gradHash(ivec3 c, int wrap) {
     c = ((c % wrap) + wrap) % wrap;
-    int n  = c.x + c.y * 137 + c.z * 7919;
+    int n  = c.x + c.y * 137 + c.z * 7919 + u_Seed * 104729;
     int n2 = (n  << 13) ^ n;  n2 = n2 * (n2 * n2 * 15731 + 789221) + 1376312589;
     int n3 = (n2 << 13) ^ n2; n3 = n3 * (n3 * n3 * 15731 + 789221) + 1376312589;
     int n4 = (n3 << 13) ^ n3; n4 = n4 * (n4 * n4 * 15731 + 789221) + 1376312589;
@@ -101,11 +121,10 @@ float worley(vec3 pos, int cellCount) {
 }
 
 void main() {
-    ivec3 coord = ivec3(gl_GlobalInvocationID);
+    ivec3 coord = ivec3(gl_GlobalInvocationID) + ivec3(0, 0, u_SlabOffset);
     if (any(greaterThanEqual(coord, ivec3(u_Resolution)))) return;
 
     vec3 pos = (vec3(coord) + 0.5) / float(u_Resolution);
-    pos += vec3(u_Time * u_Speed, u_Time * u_Speed * 0.7, u_Time * u_Speed * 0.3);
 
     float noise = 0.0;
     float amplitude = 1.0;
@@ -138,28 +157,89 @@ void main() {
 )";
 
         cs.setUp(src);
-    }
 
-    void generate(float time) {
-        texture.bindImage(0, GL_WRITE_ONLY);
-        cs.use();
-        cs.setFloat("u_Time", time);
-        cs.setInt("u_Resolution", resolution);
-        cs.setInt("u_CellCount", 4);
-        cs.setInt("u_Octaves", 3);
-        cs.setFloat("u_Persistence", 0.5f);
-        cs.setFloat("u_Speed", 0.025f);
-        cs.dispatch(resolution, resolution, resolution);
+        // Build the static volume once; generate() only does work in evolve mode.
+        generateSlabs(texture, 0, 0, resolution);
         glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
     }
 
+    // The volume `texture` is crossfaded toward; `texture` itself outside
+    // evolve mode.
+    const Texture3D& nextTexture() const { return evolve && next.ID ? next : texture; }
+
+    // Crossfade weight toward nextTexture(), in [0, 1).
+    float blend() const { return evolve ? progress : 0.0f; }
+
+    // Per-frame hook. A no-op unless evolve mode is on, in which case it
+    // builds the next slab range of the coming volume and rotates the
+    // volumes once it is complete.
+    void generate() {
+        if (!evolve) return;
+
+        if (next.ID == 0) {
+            // First cycle: the volume to fade toward is built in one go.
+            createVolume(next);
+            createVolume(building);
+            generateSlabs(next, ++seed, 0, resolution);
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+            nextSlab = 0;
+        }
+
+        int slabDepth = std::max(1, (resolution + slicesPerCycle - 1) / std::max(1, slicesPerCycle));
+        int count     = std::min(slabDepth, resolution - nextSlab);
+
+        generateSlabs(building, seed + 1, nextSlab, count);
+        nextSlab += count;
+        progress = (float)nextSlab / (float)resolution;
+
+        if (nextSlab >= resolution) {
+            // Complete: make the writes visible to texture() and rotate.
+            // Blend 0 on the rotated volumes equals blend 1 on the old ones.
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+            std::swap(texture, next);
+            std::swap(next, building);
+            seed++;
+            nextSlab = 0;
+            progress = 0.0f;
+        }
+    }
+
     void destroy() {
         texture.destroy();
+        next.destroy();
+        building.destroy();
         glDeleteProgram(cs.ID);
     }
 
 private:
     ComputeShader cs;
+    Texture3D     next;       // evolve mode only: fully built, faded toward
+    Texture3D     building;   // evolve mode only: filled a slab range per frame
+    int           nextSlab = 0;
+    int           seed     = 0;      // seed of `next`; `building` gets seed + 1
+    float         progress = 0.0f;   // fraction of `building` done
+
+    void createVolume(Texture3D& tex) {
+        tex.create(resolution, resolution, resolution, GL_R16F);
+        glBindTexture(GL_TEXTURE_3D, tex.ID);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
+        glBindTexture(GL_TEXTURE_3D, 0);
+    }
+
+    // Write Z slices [firstSlab, firstSlab + slabCount) of `target`.
+    void generateSlabs(const Texture3D& target, int cycleSeed, int firstSlab, int slabCount) {
+        target.bindImage(0, GL_WRITE_ONLY);
+        cs.use();
+        cs.setInt("u_Seed", cycleSeed);
+        cs.setInt("u_Resolution", resolution);
+        cs.setInt("u_CellCount", 4);
+        cs.setInt("u_Octaves", 3);
+        cs.setFloat("u_Persistence", 0.5f);
+        cs.setInt("u_SlabOffset", firstSlab);
+        cs.dispatch(resolution, resolution, slabCount);
+    }
 };
 
 #endif // WORLEY_NOISE_H
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <algorithm>
+
+#include "core/ComputeShader.h"
+#include "core/Texture2D.h"
+
+// Hierarchical min/max linear depth, built once per frame right after
+// SceneDepthPass.
+//
+// Level 0 is full resolution; level n is a 2^n reduction. Every consumer
+// reads the level that matches its own pixel footprint instead of point
+// sampling the full-res depth buffer:
+//   - the raymarcher clips each low-res ray at the farthest depth (G) of
+//     the level matching its resolution scale,
+//   - the bilateral upsampler weights neighbours against that same value,
+//   - the screen-tile classifier uses it as a Hi-Z buffer to drop tiles
+//     whose smoke lies entirely behind the scene.
+// R (nearest depth) is kept for edge detection.
+class DepthPyramid {
+public:
+    Texture2D tex;   // RG32F, R = min, G = max linear view depth
+
+    void init(int width, int height) {
+        pyramidCS.setUpFromFile("shaders/smoke/DepthPyramid.comp");
+        createTexture(width, height);
+    }
+
+    void resize(int width, int height) {
+        if (width == tex.width && height == tex.height) return;
+        tex.destroy();
+        createTexture(width, height);
+    }
+
+    void build(const Texture2D& depthTex, float zNear, float zFar) {
+        depthTex.bindSampler(0);
+
+        pyramidCS.use();
+        pyramidCS.setInt  ("u_DepthTex", 0);
+        pyramidCS.setFloat("u_Near",     zNear);
+        pyramidCS.setFloat("u_Far",      zFar);
+
+        int srcW = tex.width, srcH = tex.height;
+        for (int level = 0; level < tex.levels; level++) {
+            int dstW = levelSize(tex.width,  level);
+            int dstH = levelSize(tex.height, level);
+
+            tex.bindImage(0, GL_WRITE_ONLY, level);
+            if (level > 0) tex.bindImage(1, GL_READ_ONLY, level - 1);
+
+            pyramidCS.setInt("u_Level", level);
+            glUniform2i(glGetUniformLocation(pyramidCS.ID, "u_SrcSize"), srcW, srcH);
+            glUniform2i(glGetUniformLocation(pyramidCS.ID, "u_DstSize"), dstW, dstH);
+            pyramidCS.dispatch(dstW, dstH, 1);
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+            srcW = dstW;
+            srcH = dstH;
+        }
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+
+    // Level whose texels cover one pixel of a target rendered at
+    // resolutionScale (1.0 -> 0, 0.5 -> 1, 0.25 -> 2).
+    int levelForScale(float resolutionScale) const {
+        int level = 0;
+        while (level + 1 < tex.levels && (float)(1 << (level + 1)) * resolutionScale <= 1.0f)
+            level++;
+        return level;
+    }
+
+    static int levelSize(int base, int level) {
+        return std::max(1, base >> level);
+    }
+
+    void destroy() {
+        tex.destroy();
+        if (pyramidCS.ID) { glDeleteProgram(pyramidCS.ID); pyramidCS.ID = 0; }
+    }
+
+private:
+    ComputeShader pyramidCS;
+
+    void createTexture(int w, int h) {
+        int mipLevels = 1;
+        while ((std::max(w, h) >> mipLevels) > 0) mipLevels++;
+
+        tex.create(w, h, GL_RG32F, mipLevels);
+        glBindTexture(GL_TEXTURE_2D, tex.ID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+// Picks the raymarch render scale from measured GPU time.
+//
+// The raymarch pass is timed by GpuProfiler ("Raymarch" scope); each time
+// the profiler resolves a new frame, main feeds that time into update().
+// Results are a frame or two old, so the CPU never waits on the GPU.
+//
+// Raymarch cost is roughly proportional to pixel count, i.e. scale^2, so the
+// target scale is scale * sqrt(budget / measured), clamped to
+// [minScale, maxScale], and the output eases towards it. Targets within
+// `deadband` of the current scale are ignored to keep the image from
+// shimmering between neighbouring sizes.
+class DynamicResolution {
+public:
+    bool  enabled   = false;
+    float budgetMs  = 4.0f;    // GPU time allowed for the raymarch pass
+    float minScale  = 0.25f;
+    float maxScale  = 1.0f;
+    float smoothing = 0.15f;   // fraction of the way to the target per sample
+    float deadband  = 0.02f;
+
+    float scale     = 0.5f;    // current output, feed to Raymarcher::resolutionScale
+    float lastGpuMs = 0.0f;    // most recent measurement
+
+    // One raymarch GPU time measurement, in milliseconds.
+    void update(float gpuMs) {
+        if (!enabled || gpuMs <= 0.0f) return;
+        lastGpuMs = gpuMs;
+        float target = std::clamp(scale * std::sqrt(budgetMs / lastGpuMs), minScale, maxScale);
+        if (std::fabs(target - scale) > deadband)
+            scale = std::clamp(scale + (target - scale) * smoothing, minScale, maxScale);
+    }
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+#include <algorithm>
+
+#include "core/ComputeShader.h"
+#include "core/Buffer.h"
+#include "core/FrameRingBuffer.h"
+#include "core/Texture2D.h"
+#include "Rendering/DepthPyramid.h"
+
+// Edge-adaptive mixed resolution.
+//
+// detect() flags every full-res pixel whose bilateral 2x2 low-res
+// neighbourhood straddles a depth or transmittance edge and compacts the
+// flagged pixels into pixelListBuf. Raymarcher::refine() then re-marches
+// just those pixels at full resolution into `refined` through an indirect
+// dispatch. The upsample / composite passes take `refined` wherever
+// `edgeFlags` is set and keep the cheap bilateral result everywhere else.
+//
+// argsBuf layout (uint[4]): [0..2] re-march groups (groupPixels per group),
+// [3] flagged pixel count.
+class EdgeRefinePass {
+public:
+    bool  enabled        = false;
+    float depthThreshold = 0.05f;   // relative depth range counted as an edge
+    float alphaThreshold = 0.1f;    // transmittance range counted as an edge
+
+    Texture2D  refined;       // RGBA16F, valid where edgeFlags == 1
+    Texture2D  refinedMask;   // R16F, raymarch mask output for refined pixels
+    Texture2D  edgeFlags;     // R8, rewritten every detect()
+    SSBOBuffer argsBuf;
+    SSBOBuffer pixelListBuf;
+
+    void init(int width, int height) {
+        detectCS.setUpFromFile("shaders/smoke/EdgeDetect.comp");
+        argsBuf.allocate(4 * sizeof(GLuint));
+        argsReset = { 0u, 1u, 1u, 0u };
+        createTargets(width, height);
+    }
+
+    void resize(int width, int height) {
+        if (width == refined.width && height == refined.height) return;
+        destroyTargets();
+        createTargets(width, height);
+    }
+
+    // smokeTex: raymarch output, valid in [0, smokeW) x [0, smokeH).
+    // groupPixels: invocations per Raymarch.comp work group (Raymarcher::groupSize()).
+    void detect(const Texture2D&    smokeTex,
+                int smokeW, int smokeH,
+                const DepthPyramid& depthPyramid,
+                int groupPixels)
+    {
+        int outW = refined.width;
+        int outH = refined.height;
+        float ratio = std::min((float)smokeW / outW, (float)smokeH / outH);
+
+        FrameRingBuffer::instance().upload(argsBuf, argsReset);
+
+        edgeFlags.bindImage(0, GL_WRITE_ONLY);
+        pixelListBuf.bindBase(4);
+        argsBuf.bindBase(5);
+        smokeTex.bindSampler(0);
+        depthPyramid.tex.bindSampler(1);
+
+        detectCS.use();
+        detectCS.setInt  ("u_SmokeTex",       0);
+        detectCS.setInt  ("u_DepthPyramid",   1);
+        detectCS.setInt  ("u_SmokeLevel",     depthPyramid.levelForScale(ratio));
+        detectCS.setFloat("u_DepthThreshold", depthThreshold);
+        detectCS.setFloat("u_AlphaThreshold", alphaThreshold);
+        detectCS.setInt  ("u_GroupPixels",    groupPixels);
+        glUniform2i(glGetUniformLocation(detectCS.ID, "u_SmokeSize"), smokeW, smokeH);
+        glUniform2i(glGetUniformLocation(detectCS.ID, "u_OutSize"),   outW,   outH);
+        detectCS.dispatch(outW, outH, 1);
+
+        // List + count feed the re-march, args its indirect dispatch.
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT |
+                        GL_TEXTURE_FETCH_BARRIER_BIT);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void destroy() {
+        destroyTargets();
+        argsBuf.destroy();
+        if (detectCS.ID) { glDeleteProgram(detectCS.ID); detectCS.ID = 0; }
+    }
+
+private:
+    ComputeShader       detectCS;
+    std::vector<GLuint> argsReset;
+
+    void createTargets(int w, int h) {
+        refined    .create(w, h, GL_RGBA16F);
+        refinedMask.create(w, h, GL_R16F);
+        edgeFlags  .create(w, h, GL_R8);
+        // Worst case every pixel is an edge.
+        pixelListBuf.allocate((size_t)w * h * sizeof(GLuint));
+    }
+
+    void destroyTargets() {
+        refined    .destroy();
+        refinedMask.destroy();
+        edgeFlags  .destroy();
+        pixelListBuf.destroy();
+    }
+};
@@ -4,7 +4,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <cmath>
+#include <cstdint>
 #include "glVersion.h"
+#include "core/FrameRingBuffer.h"
 
 // Represents a movable directional/positional light source.
 // The light direction sent to shaders is normalize(position), treating it
@@ -105,9 +107,20 @@ public:
     void drawMarker(const glm::mat4& view, const glm::mat4& proj) {
         if (!markerReady_) return;
 
-        // Update position in VBO
-        glBindBuffer(GL_ARRAY_BUFFER, markerVBO_);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::vec3), glm::value_ptr(position));
+        // Position comes from this frame's ring slice; the VBO is only the
+        // fallback when the ring slot is full.
+        glBindVertexArray(markerVAO_);
+        FrameRingBuffer& ring = FrameRingBuffer::instance();
+        FrameRingBuffer::Slice posSlice = ring.write(position);
+        if (posSlice) {
+            glBindBuffer(GL_ARRAY_BUFFER, ring.buffer());
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (const void*)(intptr_t)posSlice.offset);
+        } else {
+            glBindBuffer(GL_ARRAY_BUFFER, markerVBO_);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::vec3), glm::value_ptr(position));
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        }
+        glBindVertexArray(0);
 
         glm::mat4 vp = proj * view;
         GLint locVP    = glGetUniformLocation(markerShader_, "u_VP");
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <iostream>
+
+#include "core/shader.h"
+#include "core/Buffer.h"
+#include "core/Framebuffer.h"
+#include "core/Texture2D.h"
+#include "Voxel/VoxelDomain.h"
+#include "glVersion.h"
+
+// Rasterizes one box per occupied smoke brick (SmokeOccupancy::brickBuf)
+// into an RG16F target. The target is allocated at window size; execute()
+// draws into the raymarch's active sub-rect only:
+//   R = -tEnter  (nearest camera-facing face, ray distance from the camera)
+//   G =  tExit   (farthest back face)
+// Both channels are resolved with GL_MAX blending, so no depth buffer is
+// needed. Cleared to (-65504, 0): R = -65504 means "no front face" and
+// G = 0 means "ray never touches a box".
+//
+// Raymarch.comp clamps its [tEnter, tExit] interval to these values. A camera
+// sitting inside a box produces back faces only; the raymarcher detects that
+// case from the brick buffer and starts the ray at 0.
+struct ProxyBoundsPass {
+    Texture2D   boundsTex;   // RG16F, max raymarch resolution
+    Framebuffer fbo;
+
+    // Extra world-space margin around each brick, in voxels: one voxel of
+    // trilinear support plus room for the raymarcher's noise warp.
+    float dilationVoxels = 2.0f;
+
+    void init(int w, int h) {
+        createResources(w, h);
+        buildShader();
+        buildCubeGeometry();
+    }
+
+    void resize(int w, int h) {
+        if (w == boundsTex.width && h == boundsTex.height) return;
+        boundsTex.destroy();
+        fbo.destroy();
+        createResources(w, h);
+    }
+
+    void execute(const SSBOBuffer& brickBuf,
+                 const glm::ivec3&  brickCount,
+                 int                brickSize,
+                 const VoxelDomain& domain,
+                 const glm::mat4&   view,
+                 const glm::mat4&   proj,
+                 int viewW, int viewH)
+    {
+        // Leave the caller's state as it was.
+        GLint prevViewport[4];
+        GLfloat prevClear[4];
+        glGetIntegerv(GL_VIEWPORT, prevViewport);
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, prevClear);
+        GLboolean prevDepthTest = glIsEnabled(GL_DEPTH_TEST);
+        GLboolean prevCullFace  = glIsEnabled(GL_CULL_FACE);
+
+        fbo.bind();
+        glViewport(0, 0, viewW, viewH);
+        glClearColor(-65504.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glDisable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+        glEnable(GL_BLEND);
+        glBlendEquation(GL_MAX);
+
+        brickBuf.bindBase(0);
+
+        boxShader.use();
+        boxShader.setMat4 ("u_ViewProj",   proj * view);
+        boxShader.setVec3 ("u_CameraPos",  glm::vec3(glm::inverse(view)[3]));
+        boxShader.setIVec3("u_BrickCount", brickCount);
+        boxShader.setInt  ("u_BrickSize",  brickSize);
+        boxShader.setIVec3("u_GridSize",   domain.gridSize);
+        boxShader.setVec3 ("u_BoundsMin",  domain.boundsMin);
+        boxShader.setFloat("u_VoxelSize",  domain.voxelSize);
+        boxShader.setFloat("u_Dilation",   dilationVoxels * domain.voxelSize);
+
+        glBindVertexArray(cubeVAO);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, brickCount.x * brickCount.y * brickCount.z);
+        glBindVertexArray(0);
+
+        glBlendEquation(GL_FUNC_ADD);
+        glDisable(GL_BLEND);
+        if (prevDepthTest) glEnable(GL_DEPTH_TEST);
+        if (prevCullFace)  glEnable(GL_CULL_FACE);
+        glClearColor(prevClear[0], prevClear[1], prevClear[2], prevClear[3]);
+
+        Framebuffer::unbind();
+        glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+    }
+
+    void destroy() {
+        boundsTex.destroy();
+        fbo.destroy();
+        if (cubeVAO) { glDeleteVertexArrays(1, &cubeVAO); cubeVAO = 0; }
+        if (cubeVBO) { glDeleteBuffers(1, &cubeVBO); cubeVBO = 0; }
+        if (boxShader.ID) { glDeleteProgram(boxShader.ID); boxShader.ID = 0; }
+    }
+
+private:
+    shader       boxShader;
+    unsigned int cubeVAO = 0, cubeVBO = 0;
+
+    void createResources(int w, int h) {
+        boundsTex.create(w, h, GL_RG16F);
+        glBindTexture(GL_TEXTURE_2D, boundsTex.ID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        fbo.create();
+        fbo.attachColor(boundsTex.ID);
+        if (!fbo.isComplete()) std::cerr << "ProxyBoundsPass FBO incomplete!\n";
+        Framebuffer::unbind();
+    }
+
+    void buildCubeGeometry() {
+        // Unit cube [0,1]^3, 36 verts. Face order (-Z,+Z,-X,+X,-Y,+Y) matters:
+        // the vertex shader derives the face normal from gl_VertexID / 6.
+        float verts[] = {
+            0,0,0, 1,0,0, 1,1,0,  1,1,0, 0,1,0, 0,0,0,
+            0,0,1, 1,0,1, 1,1,1,  1,1,1, 0,1,1, 0,0,1,
+            0,1,1, 0,1,0, 0,0,0,  0,0,0, 0,0,1, 0,1,1,
+            1,1,1, 1,1,0, 1,0,0,  1,0,0, 1,0,1, 1,1,1,
+            0,0,0, 1,0,0, 1,0,1,  1,0,1, 0,0,1, 0,0,0,
+            0,1,0, 1,1,0, 1,1,1,  1,1,1, 0,1,1, 0,1,0,
+        };
+
+        glGenVertexArrays(1, &cubeVAO);
+        glGenBuffers(1, &cubeVBO);
+        glBindVertexArray(cubeVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+    }
+
+    void buildShader() {
+        const char* vs = GLSL_VERSION
+        R"(
+layout(location = 0) in vec3 aPos;
+
+layout(std430, binding = 0) readonly buffer BrickBuf { uint brickOccupied[]; };
+
+uniform mat4  u_ViewProj;
+uniform ivec3 u_BrickCount;
+uniform int   u_BrickSize;
+uniform ivec3 u_GridSize;
+uniform vec3  u_BoundsMin;
+uniform float u_VoxelSize;
+uniform float u_Dilation;
+
+out vec3 v_WorldPos;
+flat out vec3 v_Normal;
+
+const vec3 FACE_NORMALS[6] = vec3[6](
+    vec3(0, 0, -1), vec3(0, 0, 1),
+    vec3(-1, 0, 0), vec3(1, 0, 0),
+    vec3(0, -1, 0), vec3(0, 1, 0)
+);
+
+void main() {
+    int id = gl_InstanceID;
+    v_Normal = FACE_NORMALS[gl_VertexID / 6];
+
+    if (brickOccupied[id] == 0u) {
+        v_WorldPos  = vec3(0.0);
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    ivec3 b = ivec3(id % u_BrickCount.x,
+                    (id / u_BrickCount.x) % u_BrickCount.y,
+                    id / (u_BrickCount.x * u_BrickCount.y));
+
+    vec3 lo = u_BoundsMin + vec3(b * u_BrickSize) * u_VoxelSize - u_Dilation;
+    vec3 hi = u_BoundsMin + vec3(min((b + 1) * u_BrickSize, u_GridSize)) * u_VoxelSize + u_Dilation;
+
+    v_WorldPos  = mix(lo, hi, aPos);
+    gl_Position = u_ViewProj * vec4(v_WorldPos, 1.0);
+}
+)";
+
+        const char* fs = GLSL_VERSION
+        R"(
+in vec3 v_WorldPos;
+flat in vec3 v_Normal;
+
+uniform vec3 u_CameraPos;
+
+out vec4 FragColor;
+
+void main() {
+    vec3  toCam = u_CameraPos - v_WorldPos;
+    float t     = length(toCam);
+    // Facing is derived geometrically so it does not depend on triangle winding.
+    // MAX blending: R keeps the smallest front-face t, G the largest back-face t.
+    bool front = dot(v_Normal, toCam) > 0.0;
+    FragColor  = front ? vec4(-t, 0.0, 0.0, 0.0)
+                       : vec4(-65504.0, t, 0.0, 0.0);
+}
+)";
+
+        boxShader.setUpShader(vs, fs);
+    }
+};
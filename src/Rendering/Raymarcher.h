@@ -4,29 +4,94 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <algorithm>
+#include <iostream>
+#include <vector>
 
 #include "core/ComputeShader.h"
+#include "core/ShaderVariants.h"
+#include "core/WorkgroupConfig.h"
+#include "core/WorkgroupTuner.h"
 #include "core/Buffer.h"
 #include "core/Texture2D.h"
 #include "core/Texture3D.h"
 #include "core/FullscreenQuad.h"
+#include "core/UniformBlock.h"
 #include "core/shader.h"
 #include "Voxel/VoxelDomain.h"
 #include "Rendering/LightSource.h"
+#include "Rendering/SmokeOccupancy.h"
+#include "Rendering/ScreenTileClassifier.h"
+#include "Rendering/ProxyBoundsPass.h"
+#include "Rendering/DepthPyramid.h"
+#include "Rendering/EdgeRefinePass.h"
+#include "Procedural/WorleyNoise.h"
+#ifdef SMOKE_STATS
+#include "core/ShaderStats.h"
+#endif
 #include "glVersion.h"
 
 // Volumetric ray marcher.
 //
-// Renders smoke at half resolution into an RGBA16F image via compute shader,
+// Renders smoke at resolutionScale into an RGBA16F image via compute shader,
 // then blits the result to screen with alpha-based compositing.
 //
-// Inputs:   smoke density SSBO, wall SSBO, scene depth texture
+// Output textures are allocated at window size once; a lower scale only
+// shrinks the [0, renderW) x [0, renderH) sub-rect that gets written, so the
+// scale can change every frame (DynamicResolution) without reallocating.
+//
+// Inputs:   smoke density SSBO, wall SSBO, scene depth pyramid
 // Output:   smokeOut texture (RGB = scattered light, A = transmittance)
+//
+// With tileCulling on, a pre-pass reduces the density grid to an active
+// AABB, classifies output tiles (one march work group, 16x16 unless
+// autotune() picked another size) against its screen projection and the
+// depth pyramid (Hi-Z), and the march is dispatched indirectly over occupied
+// tiles only. Empty or fully occluded tiles get a trivial clear to
+// transmittance 1.
+//
+// With proxyBounds on, the occupied bricks are rasterized as boxes into a
+// per-pixel [tEnter, tExit] texture and each ray is clipped to it, which
+// replaces the coarse density hunt.
+//
+// All march parameters travel in one std140 block (RaymarchParams), written
+// to the frame ring once per dispatch; samplers and images use fixed bindings.
 class Raymarcher {
 public:
+    // Mirror of the RaymarchParams block in Raymarch.comp.
+    struct RaymarchParams {
+        glm::mat4  invView{1.0f};
+        glm::mat4  invProj{1.0f};
+        glm::ivec3 gridSize{0};       float voxelSize     = 1.0f;
+        glm::vec3  boundsMin{0.0f};   float densityScale  = 0.0f;
+        glm::vec3  boundsMax{0.0f};   float sigmaS        = 0.0f;
+        glm::vec3  lightDir{0.0f};    float sigmaA        = 0.0f;
+        glm::vec3  lightColor{0.0f};  float phaseBlend    = 0.0f;
+        glm::ivec3 brickCount{0};     float g             = 0.0f;
+        float time          = 0.0f;
+        float edgeFadeWidth = 0.0f;
+        float curlStrength  = 0.0f;
+        float noiseStrength = 0.0f;
+        float noiseScale    = 0.0f;
+        float hazeFloor     = 0.0f;
+        float proxyDilation = 0.0f;
+        int   brickSize     = 0;
+        glm::ivec2 texSize{0};
+        glm::vec2  jitter{0.0f};
+        int   depthLevel     = 0;
+        int   useTileList    = 0;
+        int   tileCountX     = 0;
+        int   usePixelList   = 0;
+        int   useProxyBounds = 0;
+        float noiseBlend     = 0.0f;
+        int   pad_[2]        = {};
+    };
+
     Texture2D smokeOut;
     Texture2D smokeMask;  // R16F transmittance — kept at low-res for soft edge compositing
 
+    // Active sub-rect of smokeOut / smokeMask written by the last render().
+    int renderW = 0, renderH = 0;
+
     // Tweakable parameters
     float densityScale = 30.0f;
 
@@ -41,90 +106,234 @@ public:
     float noiseStrength  = 0.85f;
     float noiseScale     = 2.0f;
     float hazeFloor      = 0.0f;   // 0 = many holes, 1 = smooth blob
-    // Internal raymarch render scale (1.0 = full-res, 0.5 = half-res, 0.25 = quarter-res).
+    // Internal raymarch render scale, any value in (0, 1]
+    // (1.0 = full-res, 0.5 = half-res, 0.25 = quarter-res).
     float resolutionScale = 0.5f;
 
+    // Skip screen tiles whose rays cannot touch smoke (indirect dispatch).
+    bool tileCulling = true;
+    // Clip rays to rasterized occupied-brick boxes.
+    bool proxyBounds = true;
+
+    // Sub-pixel ray offset in render pixels, set per frame by TemporalUpscaler.
+    glm::vec2 jitter{0.0f};
+
+    SmokeOccupancy       occupancy;
+    ScreenTileClassifier tileClassifier;
+    ProxyBoundsPass      proxyPass;
+
     void init(int fullWidth, int fullHeight) {
-        halfW = std::max(1, (int)(fullWidth  * resolutionScale));
-        halfH = std::max(1, (int)(fullHeight * resolutionScale));
+        maxW = std::max(1, fullWidth);
+        maxH = std::max(1, fullHeight);
 
-        smokeOut.create(halfW, halfH, GL_RGBA16F);
-        smokeMask.create(halfW, halfH, GL_R16F);
+        smokeOut.create(maxW, maxH, GL_RGBA16F);
+        smokeMask.create(maxW, maxH, GL_R16F);
 
-        marchCS.setUpFromFile("shaders/smoke/Raymarch.comp");
+        march.setUpFromFile("shaders/smoke/Raymarch.comp");
+        march.select(ShaderVariants::Spec{});
         buildBlitShader();
+
+        occupancy.init();
+        tileClassifier.init();
+        proxyPass.init(maxW, maxH);
     }
 
+    // Window size changed. Changing resolutionScale does not need this.
     void resize(int fullWidth, int fullHeight) {
-        int newW = std::max(1, (int)(fullWidth  * resolutionScale));
-        int newH = std::max(1, (int)(fullHeight * resolutionScale));
-        if (newW == halfW && newH == halfH) return;
-        halfW = newW;
-        halfH = newH;
+        int newW = std::max(1, fullWidth);
+        int newH = std::max(1, fullHeight);
+        if (newW == maxW && newH == maxH) return;
+        maxW = newW;
+        maxH = newH;
         smokeOut.destroy();
-        smokeOut.create(halfW, halfH, GL_RGBA16F);
+        smokeOut.create(maxW, maxH, GL_RGBA16F);
         smokeMask.destroy();
-        smokeMask.create(halfW, halfH, GL_R16F);
+        smokeMask.create(maxW, maxH, GL_R16F);
+        proxyPass.resize(maxW, maxH);
     }
 
     void render(const SSBOBuffer& smokeBuf,
             const SSBOBuffer& wallBuf,
-            const Texture2D&  depthTex,
-            const Texture3D&  noiseTex,
+            const DepthPyramid& depthPyramid,
+            const WorleyNoise& noise,
             const VoxelDomain& domain,
             const glm::mat4& view,
             const glm::mat4& proj,
-            float zNear, float zFar,
             float timeSec,
             const LightSource& light)
     {
         glm::mat4 invView = glm::inverse(view);
         glm::mat4 invProj = glm::inverse(proj);
+        int depthLevel    = depthPyramid.levelForScale(resolutionScale);
+
+        renderW = std::clamp((int)(maxW * resolutionScale), 1, maxW);
+        renderH = std::clamp((int)(maxH * resolutionScale), 1, maxH);
+
+        if (tileCulling || proxyBounds)
+            occupancy.update(smokeBuf, domain);
+
+        tileClassifier.setTileSize(groupSize());
+        if (tileCulling) {
+            // One voxel of trilinear support plus a safety voxel.
+            tileClassifier.classify(occupancy.boundsBuf, depthPyramid, depthLevel,
+                                    domain, proj * view,
+                                    renderW, renderH, domain.voxelSize * 2.0f);
+        }
+
+        if (proxyBounds) {
+            proxyPass.execute(occupancy.brickBuf, occupancy.brickCount,
+                              SmokeOccupancy::BRICK_SIZE, domain, view, proj,
+                              renderW, renderH);
+        }
 
         smokeOut.bindImage(0, GL_WRITE_ONLY);
         smokeMask.bindImage(1, GL_WRITE_ONLY);
+#ifdef SMOKE_STATS
+        ShaderStats::instance().bindStepsImage();
+#endif
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, depthTex.ID);
+        if (tileCulling)
+            tileClassifier.clearEmptyTiles(renderW, renderH);
 
-        noiseTex.bindSampler(1);
+        // Samplers: 0 = depth pyramid, 1/3 = noise and the volume it fades
+        // toward, 2 = proxy bounds
+        depthPyramid.tex.bindSampler(0);
+        noise.texture.bindSampler(1);
+        proxyPass.boundsTex.bindSampler(2);
+        noise.nextTexture().bindSampler(3);
 
         smokeBuf.bindBase(0);
         wallBuf.bindBase(1);
+        occupancy.brickBuf.bindBase(3);
+
+        RaymarchParams& p = params;
+        p.invView      = invView;
+        p.invProj      = invProj;
+        p.gridSize     = domain.gridSize;
+        p.boundsMin    = domain.boundsMin;
+        p.boundsMax    = domain.boundsMax;
+        p.voxelSize    = domain.voxelSize;
+
+        p.densityScale = densityScale;
+        p.sigmaS       = sigmaS;
+        p.sigmaA       = sigmaA;
+        p.phaseBlend   = phaseBlend;
+        p.g            = g;
+
+        p.lightDir     = light.getDirection();
+        p.lightColor   = light.getColor();
+        p.time         = timeSec;
+
+        p.edgeFadeWidth = edgeFadeWidth;
+        p.curlStrength  = curlStrength;
+        p.noiseStrength = noiseStrength;
+        p.noiseScale    = noiseScale;
+        p.noiseBlend    = noise.blend();
+        p.hazeFloor     = hazeFloor;
+
+        p.texSize    = glm::ivec2(renderW, renderH);
+        p.jitter     = jitter;
+        p.depthLevel = depthLevel;
+
+        p.useProxyBounds = proxyBounds ? 1 : 0;
+        p.brickCount     = occupancy.brickCount;
+        p.brickSize      = SmokeOccupancy::BRICK_SIZE;
+        p.proxyDilation  = proxyPass.dilationVoxels * domain.voxelSize;
+
+        p.usePixelList = 0;
+        p.useTileList  = tileCulling ? 1 : 0;
+        p.tileCountX   = tileClassifier.tileCount.x;
+
+        UniformBlock::bind(p);
+        if (tileCulling) tileClassifier.tileListBuf.bindBase(2);
+        dispatchMarch();
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+
+    // Times the march at each candidate workgroup (= tile) size on this
+    // frame's view, keeps the fastest and saves it to WorkgroupConfig. Takes
+    // render()'s arguments and leaves the outputs as render() would. Blocks
+    // on GPU queries; call outside GPU scopes.
+    void autotune(const SSBOBuffer& smokeBuf,
+                  const SSBOBuffer& wallBuf,
+                  const DepthPyramid& depthPyramid,
+                  const WorleyNoise& noise,
+                  const VoxelDomain& domain,
+                  const glm::mat4& view,
+                  const glm::mat4& proj,
+                  float timeSec,
+                  const LightSource& light)
+    {
+        static const glm::ivec3 GROUP_CANDIDATES[] = {
+            { 16, 16, 1 }, {  8,  8, 1 }, { 16,  8, 1 }, {  8, 16, 1 },
+            { 32,  8, 1 }, { 32,  4, 1 }, {  8, 32, 1 }, { 32, 16, 1 },
+        };
+        const std::vector<glm::ivec3> candidates = WorkgroupTuner::supported(GROUP_CANDIDATES);
+        std::cout << "[Autotune] " << candidates.size() << " workgroup sizes for "
+                  << march.name() << "\n";
+
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        const size_t clearFirst = tileClassifier.clearVariantCount();
+        glm::ivec2 rendered(0);
+        WorkgroupTuner::tune(march, candidates, query, [&] {
+            // A new size means new tiles: the first (warm-up) call renders
+            // in full, the timed ones repeat just the march.
+            if (groupSize() != rendered) {
+                render(smokeBuf, wallBuf, depthPyramid, noise, domain, view, proj, timeSec, light);
+                rendered = groupSize();
+            } else {
+                dispatchMarch();
+            }
+        });
+        render(smokeBuf, wallBuf, depthPyramid, noise, domain, view, proj, timeSec, light);
+        tileClassifier.releaseClearVariants(clearFirst);
+        glDeleteQueries(1, &query);
+        WorkgroupConfig::instance().save();
+    }
+
+    // Work group (and screen tile) size of the march, in pixels.
+    glm::ivec2 groupSize() const {
+        return march.local.x > 0 ? glm::ivec2(march.local) : glm::ivec2(16);
+    }
+
+    // Re-march the pixels EdgeRefinePass::detect() listed, at full resolution,
+    // into pass.refined. Must follow render() in the same frame: it reuses
+    // render()'s parameters with the dispatch-specific fields overridden.
+    void refine(const EdgeRefinePass& pass,
+                const SSBOBuffer&     smokeBuf,
+                const SSBOBuffer&     wallBuf,
+                const DepthPyramid&   depthPyramid,
+                const WorleyNoise&    noise)
+    {
+        pass.refined    .bindImage(0, GL_WRITE_ONLY);
+        pass.refinedMask.bindImage(1, GL_WRITE_ONLY);
 
+        depthPyramid.tex.bindSampler(0);
+        noise.texture.bindSampler(1);
+        noise.nextTexture().bindSampler(3);
+
+        smokeBuf.bindBase(0);
+        wallBuf.bindBase(1);
+        pass.pixelListBuf.bindBase(4);
+        pass.argsBuf.bindBase(5);
+
+        RaymarchParams p = params;
+        p.texSize    = glm::ivec2(pass.refined.width, pass.refined.height);
+        p.jitter     = glm::vec2(0.0f);
+        p.depthLevel = 0;
+        // The proxy texture is at render resolution; full-res rays use the box only.
+        p.useProxyBounds = 0;
+        p.useTileList    = 0;
+        p.usePixelList   = 1;
+
+        UniformBlock::bind(p);
+        const ComputeShader& marchCS = march.current();
         marchCS.use();
-        marchCS.setMat4 ("u_InvView",      invView);
-        marchCS.setMat4 ("u_InvProj",      invProj);
-        marchCS.setFloat("u_Near",         zNear);
-        marchCS.setFloat("u_Far",          zFar);
-        marchCS.setIVec3("u_GridSize",     domain.gridSize);
-        marchCS.setVec3 ("u_BoundsMin",    domain.boundsMin);
-        marchCS.setVec3 ("u_BoundsMax",    domain.boundsMax);
-        marchCS.setFloat("u_VoxelSize",    domain.voxelSize);
-
-        marchCS.setFloat("u_DensityScale", densityScale);
-        marchCS.setFloat("u_SigmaS",       sigmaS);
-        marchCS.setFloat("u_SigmaA",       sigmaA);
-        marchCS.setFloat("u_PhaseBlend",   phaseBlend);
-        marchCS.setFloat("u_G",            g);
-
-        marchCS.setVec3 ("u_LightDir",     light.getDirection());
-        marchCS.setVec3 ("u_LightColor",   light.getColor());
-        marchCS.setFloat("u_Time",         timeSec);
-
-        marchCS.setFloat("u_EdgeFadeWidth", edgeFadeWidth);
-        marchCS.setFloat("u_CurlStrength",  curlStrength);
-        marchCS.setFloat("u_NoiseStrength", noiseStrength);
-        marchCS.setFloat("u_NoiseScale",    noiseScale);
-        marchCS.setFloat("u_HazeFloor",     hazeFloor);
-
-        glUniform2i(glGetUniformLocation(marchCS.ID, "u_TexSize"), halfW, halfH);
-
-        marchCS.setInt("u_DepthTex", 0);
-        marchCS.setInt("u_NoiseTex", 1);
-
-        marchCS.dispatch(halfW, halfH, 1);
-        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        marchCS.dispatchIndirect(pass.argsBuf.ID, 0);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+        glActiveTexture(GL_TEXTURE0);
     }
 
     void blit(FullscreenQuad& quad) {
@@ -133,6 +342,8 @@ public:
 
         blitShader.use();
         blitShader.setInt("u_SmokeTex", 0);
+        glUniform2f(glGetUniformLocation(blitShader.ID, "u_UVScale"),
+                    (float)renderW / maxW, (float)renderH / maxH);
         smokeOut.bindSampler(0);
 
         glDisable(GL_DEPTH_TEST);
@@ -145,14 +356,29 @@ public:
     void destroy() {
         smokeOut.destroy();
         smokeMask.destroy();
-        if (marchCS.ID)    { glDeleteProgram(marchCS.ID);    marchCS.ID = 0; }
+        occupancy.destroy();
+        tileClassifier.destroy();
+        proxyPass.destroy();
+        march.destroy();
         if (blitShader.ID) { glDeleteProgram(blitShader.ID); blitShader.ID = 0; }
     }
 
 private:
-    ComputeShader marchCS;
-    shader        blitShader;
-    int halfW = 0, halfH = 0;
+    ShaderVariants march;
+    shader         blitShader;
+    RaymarchParams params;   // last render()'s block, the base for refine()
+    int maxW = 0, maxH = 0;
+
+    // The march over render()'s tiles or sub-rect, with its block and
+    // bindings already in place.
+    void dispatchMarch() {
+        const ComputeShader& marchCS = march.current();
+        marchCS.use();
+        if (tileCulling)
+            marchCS.dispatchIndirect(tileClassifier.argsBuf.ID, ScreenTileClassifier::MARCH_ARGS_OFFSET);
+        else
+            marchCS.dispatch(renderW, renderH, 1);
+    }
 
     void buildBlitShader() {
         const char* vs = GLSL_VERSION
@@ -165,11 +391,29 @@ private:
             "in vec2 vUV;\n"
             "out vec4 FragColor;\n"
             "uniform sampler2D u_SmokeTex;\n"
+            "uniform vec2 u_UVScale;\n"   // active sub-rect / texture size
             "void main() {\n"
-            "    vec4 smoke = texture(u_SmokeTex, vUV);\n"
+            "    vec4 smoke = texture(u_SmokeTex, vUV * u_UVScale);\n"
             "    FragColor = vec4(smoke.rgb, smoke.a);\n"
             "}\n";
 
         blitShader.setUpShader(vs, fs);
     }
-};
\ No newline at end of file
+};
+
+STD140_OFFSET(Raymarcher::RaymarchParams, invProj,       64);
+STD140_OFFSET(Raymarcher::RaymarchParams, gridSize,      128);
+STD140_OFFSET(Raymarcher::RaymarchParams, voxelSize,     140);
+STD140_OFFSET(Raymarcher::RaymarchParams, boundsMin,     144);
+STD140_OFFSET(Raymarcher::RaymarchParams, boundsMax,     160);
+STD140_OFFSET(Raymarcher::RaymarchParams, lightDir,      176);
+STD140_OFFSET(Raymarcher::RaymarchParams, lightColor,    192);
+STD140_OFFSET(Raymarcher::RaymarchParams, brickCount,    208);
+STD140_OFFSET(Raymarcher::RaymarchParams, time,          224);
+STD140_OFFSET(Raymarcher::RaymarchParams, noiseScale,    240);
+STD140_OFFSET(Raymarcher::RaymarchParams, texSize,       256);
+STD140_OFFSET(Raymarcher::RaymarchParams, jitter,        264);
+STD140_OFFSET(Raymarcher::RaymarchParams, depthLevel,    272);
+STD140_OFFSET(Raymarcher::RaymarchParams, useProxyBounds, 288);
+STD140_OFFSET(Raymarcher::RaymarchParams, noiseBlend,    292);
+STD140_SIZE(Raymarcher::RaymarchParams, 304);
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "core/ComputeShader.h"
+#include "core/ShaderVariants.h"
+#include "core/Buffer.h"
+#include "core/FrameRingBuffer.h"
+#include "core/Texture2D.h"
+#include "Rendering/DepthPyramid.h"
+#include "Voxel/VoxelDomain.h"
+
+// Splits the raymarch output into tileSize tiles and sorts them into
+// "touches smoke" / "empty" lists on the GPU, so the raymarcher can be
+// dispatched indirectly over occupied tiles only while empty tiles get a
+// trivial clear to transmittance 1. Tiles whose smoke lies entirely behind
+// the farthest scene depth in the tile (depth pyramid, Hi-Z) count as empty.
+// A tile is one Raymarch.comp work group, so tileSize follows the march's
+// (tuned) workgroup size through setTileSize().
+//
+// argsBuf layout (uint[6], bound as GL_DISPATCH_INDIRECT_BUFFER):
+//   offset  0: raymarch groups (occupied tile count, 1, 1)
+//   offset 12: clear groups    (empty tile count,    1, 1)
+class ScreenTileClassifier {
+public:
+    static constexpr GLintptr MARCH_ARGS_OFFSET = 0;
+    static constexpr GLintptr CLEAR_ARGS_OFFSET = 3 * sizeof(GLuint);
+
+    SSBOBuffer argsBuf;
+    SSBOBuffer tileListBuf;
+    glm::ivec2 tileCount{0};
+    glm::ivec2 tileSize{16};   // == Raymarch.comp local_size
+
+    void init() {
+        classifyCS.setUpFromFile("shaders/smoke/RaymarchTileClassify.comp");
+        clear     .setUpFromFile("shaders/smoke/RaymarchTileClear.comp");
+        argsBuf.allocate(6 * sizeof(GLuint));
+        argsReset = { 0u, 1u, 1u, 0u, 1u, 1u };
+        setTileSize(tileSize);
+    }
+
+    // Tile size in raymarch pixels, the march's workgroup size. Selects the
+    // clear kernel built for the same size.
+    void setTileSize(const glm::ivec2& size) {
+        tileSize    = size;
+        clear.local = glm::ivec3(size, 1);
+        clear.select(ShaderVariants::Spec{});
+    }
+
+    // Deletes clear kernels built since clearVariantCount() was `first`
+    // for sizes other than the current one (Raymarcher::autotune).
+    size_t clearVariantCount() const { return clear.variantCount(); }
+    void   releaseClearVariants(size_t first) { clear.release(first); }
+
+    // Build this frame's tile lists. boundsBuf comes from SmokeOccupancy;
+    // texLevel is the pyramid level matching one raymarch pixel.
+    void classify(const SSBOBuffer& boundsBuf,
+                  const DepthPyramid& depthPyramid,
+                  int texLevel,
+                  const VoxelDomain& domain,
+                  const glm::mat4& viewProj,
+                  int texW, int texH,
+                  float paddingWorld)
+    {
+        glm::ivec2 tiles((texW + tileSize.x - 1) / tileSize.x,
+                         (texH + tileSize.y - 1) / tileSize.y);
+        tileCount = tiles;
+        // Grow-only: the raymarch scale may change every frame.
+        if (tiles.x * tiles.y > tileCapacity) {
+            tileCapacity = tiles.x * tiles.y;
+            tileListBuf.allocate((size_t)tileCapacity * sizeof(GLuint));
+        }
+
+        FrameRingBuffer::instance().upload(argsBuf, argsReset);
+
+        boundsBuf.bindBase(0);
+        argsBuf.bindBase(1);
+        tileListBuf.bindBase(2);
+        depthPyramid.tex.bindSampler(0);
+
+        // One tile spans up to 2^k texels of texLevel along its longer side.
+        int tileLog2 = (int)std::ceil(std::log2((float)std::max(tileSize.x, tileSize.y)));
+        int hizLevel = std::min(texLevel + tileLog2, depthPyramid.tex.levels - 1);
+
+        classifyCS.use();
+        classifyCS.setInt  ("u_DepthPyramid", 0);
+        classifyCS.setInt  ("u_HiZLevel",     hizLevel);
+        classifyCS.setMat4 ("u_ViewProj",  viewProj);
+        glUniform2i(glGetUniformLocation(classifyCS.ID, "u_TexSize"),   texW, texH);
+        glUniform2i(glGetUniformLocation(classifyCS.ID, "u_TileCount"), tileCount.x, tileCount.y);
+        glUniform2i(glGetUniformLocation(classifyCS.ID, "u_TileSize"),  tileSize.x, tileSize.y);
+        classifyCS.setVec3 ("u_BoundsMin", domain.boundsMin);
+        classifyCS.setFloat("u_VoxelSize", domain.voxelSize);
+        classifyCS.setFloat("u_Padding",   paddingWorld);
+        classifyCS.dispatch(tileCount.x, tileCount.y, 1);
+
+        // Tile list is read by shaders, args by the indirect dispatches.
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+    }
+
+    // Write "no smoke" into every empty tile. Output images must already be
+    // bound at image units 0 (RGBA16F) and 1 (R16F).
+    void clearEmptyTiles(int texW, int texH) {
+        tileListBuf.bindBase(2);
+        const ComputeShader& clearCS = clear.current();
+        clearCS.use();
+        glUniform2i(glGetUniformLocation(clearCS.ID, "u_TexSize"),   texW, texH);
+        glUniform2i(glGetUniformLocation(clearCS.ID, "u_TileCount"), tileCount.x, tileCount.y);
+        clearCS.dispatchIndirect(argsBuf.ID, CLEAR_ARGS_OFFSET);
+    }
+
+    void destroy() {
+        argsBuf.destroy();
+        tileListBuf.destroy();
+        tileCount = glm::ivec2(0);
+        tileCapacity = 0;
+        if (classifyCS.ID) { glDeleteProgram(classifyCS.ID); classifyCS.ID = 0; }
+        clear.destroy();
+    }
+
+private:
+    ComputeShader       classifyCS;
+    ShaderVariants      clear;
+    std::vector<GLuint> argsReset;
+    int                 tileCapacity = 0;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "core/ComputeShader.h"
+#include "core/Buffer.h"
+#include "core/FrameRingBuffer.h"
+#include "Voxel/VoxelDomain.h"
+
+// Per-frame smoke occupancy summary used to cull empty screen space.
+//
+// One compute pass over the density grid produces:
+//   brickBuf  — one uint per 8x8x8 brick, 1 if any voxel holds smoke
+//   boundsBuf — voxel-space AABB of all smoke voxels (ivec4 min, ivec4 max;
+//               max.x < 0 means the grid is empty)
+// Both stay on the GPU; consumers bind them as SSBOs.
+class SmokeOccupancy {
+public:
+    static constexpr int BRICK_SIZE = 8;   // must match SmokeBounds.comp local_size
+
+    SSBOBuffer boundsBuf;
+    SSBOBuffer brickBuf;
+    glm::ivec3 brickCount{0};
+
+    float threshold = 0.002f;   // same cut-off as the raymarcher's coarse skip
+
+    void init() {
+        boundsCS.setUpFromFile("shaders/smoke/SmokeBounds.comp");
+        boundsBuf.allocate(2 * sizeof(glm::ivec4));
+        boundsReset = {
+            0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0,
+            -1,         -1,         -1,         0
+        };
+    }
+
+    void update(const SSBOBuffer& smokeBuf, const VoxelDomain& domain) {
+        glm::ivec3 bricks = (domain.gridSize + BRICK_SIZE - 1) / BRICK_SIZE;
+        if (bricks != brickCount) {
+            brickCount = bricks;
+            brickBuf.allocate((size_t)bricks.x * bricks.y * bricks.z * sizeof(unsigned int));
+        }
+
+        FrameRingBuffer::instance().upload(boundsBuf, boundsReset);
+
+        smokeBuf.bindBase(0);
+        boundsBuf.bindBase(1);
+        brickBuf.bindBase(2);
+
+        boundsCS.use();
+        boundsCS.setIVec3("u_GridSize",  domain.gridSize);
+        boundsCS.setFloat("u_Threshold", threshold);
+        boundsCS.dispatch(domain.gridSize.x, domain.gridSize.y, domain.gridSize.z);
+
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    void destroy() {
+        boundsBuf.destroy();
+        brickBuf.destroy();
+        brickCount = glm::ivec3(0);
+        if (boundsCS.ID) { glDeleteProgram(boundsCS.ID); boundsCS.ID = 0; }
+    }
+
+private:
+    ComputeShader    boundsCS;
+    std::vector<int> boundsReset;
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+
+#include "core/ComputeShader.h"
+#include "core/Texture2D.h"
+#include "Rendering/DepthPyramid.h"
+
+// Temporal super-resolution for the smoke layer.
+//
+// Each frame nextJitter() hands the raymarcher a sub-pixel ray offset;
+// resolve() folds the jittered low-res result into a full-res history
+// (see SmokeTemporalResolve.comp for the per-pixel logic). Reprojection uses
+// the scene depth and the previous frame's view-projection, so OrbitCamera
+// rotation, zoom and pan are followed without motion vectors; smoke motion
+// is handled by clamping history to the current neighbourhood.
+//
+// The jitter walks a 4x4 Bayer order: the first 4 offsets already cover the
+// 2x2 sub-pixels of a half-res texel, all 16 cover the 4x4 of a quarter-res
+// texel, so at those scales every full-res pixel gets a real ray regularly.
+class TemporalUpscaler {
+public:
+    bool  enabled        = false;
+    float freshWeight    = 0.35f;  // weight of a ray that landed in the pixel
+    float depthTolerance = 0.05f;  // relative; larger mismatch = disocclusion
+
+    void init(int width, int height) {
+        resolveCS.setUpFromFile("shaders/smoke/SmokeTemporalResolve.comp");
+        createTargets(width, height);
+    }
+
+    void resize(int width, int height) {
+        if (width == history[0].width && height == history[0].height) return;
+        destroyTargets();
+        createTargets(width, height);
+    }
+
+    // Drop accumulated history (toggle, teleport, domain rebuild).
+    void reset() { historyValid = false; }
+
+    // Ray offset for this frame in low-res pixels, within [-0.5, 0.5).
+    glm::vec2 nextJitter() {
+        static const int BAYER[16] = { 0, 10,  2,  8,
+                                       5, 15,  7, 13,
+                                       1, 11,  3,  9,
+                                       4, 14,  6, 12 };
+        int cell = BAYER[frameIndex];
+        frameIndex = (frameIndex + 1) % 16;
+        jitter = glm::vec2((cell % 4) + 0.5f, (cell / 4) + 0.5f) / 4.0f - 0.5f;
+        return jitter;
+    }
+
+    // smokeTex: raymarch output rendered with the jitter from nextJitter(),
+    // valid in [0, smokeW) x [0, smokeH).
+    void resolve(const Texture2D&    smokeTex,
+                 int smokeW, int smokeH,
+                 const DepthPyramid& depthPyramid,
+                 const glm::mat4&    view,
+                 const glm::mat4&    proj)
+    {
+        int cur  = current ^ 1;
+        int outW = history[cur].width;
+        int outH = history[cur].height;
+        float ratio = std::min((float)smokeW / outW, (float)smokeH / outH);
+
+        history[cur]     .bindImage(0, GL_WRITE_ONLY);
+        historyDepth[cur].bindImage(1, GL_WRITE_ONLY);
+        smokeTex.bindSampler(0);
+        depthPyramid.tex.bindSampler(1);
+        history[current]     .bindSampler(2);
+        historyDepth[current].bindSampler(3);
+
+        resolveCS.use();
+        resolveCS.setInt  ("u_SmokeTex",       0);
+        resolveCS.setInt  ("u_DepthPyramid",   1);
+        resolveCS.setInt  ("u_HistoryTex",     2);
+        resolveCS.setInt  ("u_HistoryDepth",   3);
+        resolveCS.setInt  ("u_SmokeLevel",     depthPyramid.levelForScale(ratio));
+        resolveCS.setMat4 ("u_InvView",        glm::inverse(view));
+        resolveCS.setMat4 ("u_InvProj",        glm::inverse(proj));
+        resolveCS.setMat4 ("u_PrevViewProj",   prevViewProj);
+        resolveCS.setInt  ("u_HistoryValid",   historyValid ? 1 : 0);
+        resolveCS.setFloat("u_FreshWeight",    freshWeight);
+        resolveCS.setFloat("u_DepthTolerance", depthTolerance);
+        glUniform2i(glGetUniformLocation(resolveCS.ID, "u_SmokeSize"), smokeW, smokeH);
+        glUniform2i(glGetUniformLocation(resolveCS.ID, "u_OutSize"),   outW,   outH);
+        glUniform2f(glGetUniformLocation(resolveCS.ID, "u_Jitter"),    jitter.x, jitter.y);
+        resolveCS.dispatch(outW, outH, 1);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        glActiveTexture(GL_TEXTURE0);
+
+        current      = cur;
+        prevViewProj = proj * view;
+        historyValid = true;
+    }
+
+    // Full-res resolved smoke (RGB = scattered light, A = transmittance).
+    const Texture2D& output() const { return history[current]; }
+
+    void destroy() {
+        destroyTargets();
+        if (resolveCS.ID) { glDeleteProgram(resolveCS.ID); resolveCS.ID = 0; }
+    }
+
+private:
+    ComputeShader resolveCS;
+    Texture2D     history[2];        // RGBA16F ping-pong
+    Texture2D     historyDepth[2];   // R32F linear depth the history was resolved at
+    int           current      = 0;
+    bool          historyValid = false;
+    glm::mat4     prevViewProj{1.0f};
+    glm::vec2     jitter{0.0f};
+    int           frameIndex   = 0;
+
+    void createTargets(int w, int h) {
+        for (int i = 0; i < 2; i++) {
+            history[i].create(w, h, GL_RGBA16F);
+            historyDepth[i].create(w, h, GL_R32F);
+            glBindTexture(GL_TEXTURE_2D, historyDepth[i].ID);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        historyValid = false;
+    }
+
+    void destroyTargets() {
+        for (int i = 0; i < 2; i++) {
+            history[i].destroy();
+            historyDepth[i].destroy();
+        }
+    }
+};
@@ -8,8 +8,7 @@ void AdvectSmoke::iterate(const VoxelDomain& domain,
                              const SSBOBuffer& srcVelocityBuf,
                              const SSBOBuffer& srcSmokeDensityBuf,
                              SSBOBuffer& destSmokeDensityBuf,
-                             const SSBOBuffer& wallBuf,
-                             float dt) {
+                             const SSBOBuffer& wallBuf) {
     // 0 -> source velocity
     // 1 -> walls
     // 2 -> source density
@@ -20,25 +19,16 @@ void AdvectSmoke::iterate(const VoxelDomain& domain,
     srcSmokeDensityBuf.bindBase(2);
     destSmokeDensityBuf.bindBase(3);
 
+    // Parameters: the SolverParams block bound by SmokeSolver::step()
     shader_.use();
-    shader_.setIVec3("u_GridSize", domain.gridSize);
-    shader_.setFloat("u_CellSize", domain.voxelSize);
-    shader_.setFloat("u_FallOff", smokeFallOff);
-    shader_.setVec3("u_BoundsMin", domain.boundsMin);
-    shader_.setFloat("u_Dt", dt);
-    shader_.setInt  ("u_VacuumActive",   vacuumActive);
-    shader_.setVec3 ("u_VacuumWorldPos", vacuumWorldPos);
-    shader_.setFloat("u_VacuumStrength", vacuumStrength);
-    shader_.setFloat("u_VacuumRadius",   vacuumRadius);
 
     shader_.dispatch(domain.gridSize.x, domain.gridSize.y, domain.gridSize.z);
+}
 
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+void AdvectSmoke::specialise(const SolverParams& p, bool specialised) {
+    shader_.select(specialised ? solverSpec(p, SolverSpec::Vacuum) : ShaderVariants::Spec());
 }
 
 void AdvectSmoke::destroy() {
-    if (shader_.ID != 0) {
-        glDeleteProgram(shader_.ID);
-        shader_.ID = 0;
-    }
+    shader_.destroy();
 }
\ No newline at end of file
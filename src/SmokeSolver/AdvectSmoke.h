@@ -1,30 +1,32 @@
 #pragma once
 
 #include "core/Buffer.h"
-#include "core/ComputeShader.h"
+#include "core/ShaderVariants.h"
 #include "Voxel/VoxelDomain.h"
+#include "SmokeSolver/SolverParams.h"
 
 class AdvectSmoke {
 public:
     float smokeFallOff = 0.9995f;
 
-    // Set each frame by SmokeSolver from ApplyForces::VacuumState
-    int       vacuumActive    = 0;
-    glm::vec3 vacuumWorldPos  = glm::vec3(0.0f);
-    float     vacuumStrength  = 0.0f;
-    float     vacuumRadius    = 1.5f;
-
     void init();
 
+    // Vacuum suction comes from ApplyForces::fillParams().
+    void fillParams(SolverParams& p) const { p.fallOff = smokeFallOff; }
+
     void iterate(const VoxelDomain& domain,
                  const SSBOBuffer& srcVelocityBuf,
                  const SSBOBuffer& srcSmokeDensityBuf,
                  SSBOBuffer& destSmokeDensityBuf,
-                 const SSBOBuffer& wallBuf,
-                 float dt);
+                 const SSBOBuffer& wallBuf);
+
+    // Picks the shader variant for this step's parameters (see solverSpec);
+    // generic when `specialised` is false.
+    void specialise(const SolverParams& p, bool specialised);
+    ShaderVariants& variants() { return shader_; }
 
     void destroy();
 
 private:
-    ComputeShader shader_;
+    ShaderVariants shader_;
 };
\ No newline at end of file
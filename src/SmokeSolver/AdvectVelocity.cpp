@@ -7,8 +7,7 @@ void AdvectVelocity::init() {
 void AdvectVelocity::iterate(const VoxelDomain& domain,
                              const SSBOBuffer& srcVelocityBuf,
                              SSBOBuffer& destVelocityBuf,
-                             const SSBOBuffer& wallBuf,
-                             float dt) {
+                             const SSBOBuffer& wallBuf) {
     // 0 -> source velocity
     // 1 -> walls
     // 2 -> destination velocity
@@ -17,21 +16,16 @@ void AdvectVelocity::iterate(const VoxelDomain& domain,
     wallBuf.bindBase(1);
     destVelocityBuf.bindBase(2);
 
+    // Parameters: the SolverParams block bound by SmokeSolver::step()
     shader_.use();
-    shader_.setIVec3("u_GridSize", domain.gridSize);
-    shader_.setFloat("u_CellSize", domain.voxelSize);
-    shader_.setVec3("u_BoundsMin", domain.boundsMin);
-    shader_.setFloat("u_Dt", dt);
-    shader_.setFloat("u_CoolingRate", smokeCoolingRate);
 
     shader_.dispatch(domain.gridSize.x, domain.gridSize.y, domain.gridSize.z);
+}
 
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+void AdvectVelocity::specialise(const SolverParams& p, bool specialised) {
+    shader_.select(specialised ? solverSpec(p, 0) : ShaderVariants::Spec());
 }
 
 void AdvectVelocity::destroy() {
-    if (shader_.ID != 0) {
-        glDeleteProgram(shader_.ID);
-        shader_.ID = 0;
-    }
+    shader_.destroy();
 }
\ No newline at end of file
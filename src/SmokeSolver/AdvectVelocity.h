@@ -1,8 +1,9 @@
 #pragma once
 
 #include "core/Buffer.h"
-#include "core/ComputeShader.h"
+#include "core/ShaderVariants.h"
 #include "Voxel/VoxelDomain.h"
+#include "SmokeSolver/SolverParams.h"
 
 class AdvectVelocity {
 public:
@@ -11,12 +12,18 @@ public:
     void iterate(const VoxelDomain& domain,
                  const SSBOBuffer& srcVelocityBuf,
                  SSBOBuffer& destVelocityBuf,
-                 const SSBOBuffer& wallBuf,
-                 float dt);
+                 const SSBOBuffer& wallBuf);
+
+    // Picks the shader variant for this step's parameters (see solverSpec);
+    // generic when `specialised` is false.
+    void specialise(const SolverParams& p, bool specialised);
+    ShaderVariants& variants() { return shader_; }
 
     void destroy();
 
+    void fillParams(SolverParams& p) const { p.coolingRate = smokeCoolingRate; }
+
     float smokeCoolingRate = 0.01;
 private:
-    ComputeShader shader_;
+    ShaderVariants shader_;
 };
\ No newline at end of file
@@ -1,7 +1,8 @@
 #pragma once
 #include "core/Buffer.h"
-#include "core/ComputeShader.h"
+#include "core/ShaderVariants.h"
 #include "Voxel/VoxelDomain.h"
+#include "SmokeSolver/SolverParams.h"
 
 class ApplyForces {
 public:
@@ -34,16 +35,27 @@ public:
     }
 
     void init();
+
+    // Advance the vacuum timer; call before fillParams() each step.
+    void tickVacuum(float dt);
+    // Force and vacuum members of the solver block (the vacuum is shared
+    // with AdvectSmoke and PressureJacobi).
+    void fillParams(SolverParams& p) const;
+
     void dispatch(
                 const VoxelDomain& domain,
                 const SSBOBuffer& velocitySrc,
                 const SSBOBuffer& velocityDst,
                 const SSBOBuffer& smokeBuf,
-                const SSBOBuffer& wallBuf,
-                float dt);
+                const SSBOBuffer& wallBuf);
+
+    // Picks the shader variant for this step's parameters (see solverSpec);
+    // generic when `specialised` is false.
+    void specialise(const SolverParams& p, bool specialised);
+    ShaderVariants& variants() { return forceCS; }
 
     void destroy();
 
 private:
-    ComputeShader forceCS;
+    ShaderVariants forceCS;
 };
\ No newline at end of file
@@ -13,18 +13,16 @@ void ComputeDivergence::run(const VoxelDomain& domain,
     wallBuf.bindBase(1);
     divergenceBuf.bindBase(2);
 
+    // Parameters: the SolverParams block bound by SmokeSolver::step()
     shader_.use();
-    shader_.setIVec3("u_GridSize", domain.gridSize);
-    shader_.setFloat("u_CellSize", domain.voxelSize);
 
     shader_.dispatch(domain.gridSize.x, domain.gridSize.y, domain.gridSize.z);
+}
 
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+void ComputeDivergence::specialise(const SolverParams& p, bool specialised) {
+    shader_.select(specialised ? solverSpec(p, 0) : ShaderVariants::Spec());
 }
 
 void ComputeDivergence::destroy() {
-    if (shader_.ID != 0) {
-        glDeleteProgram(shader_.ID);
-        shader_.ID = 0;
-    }
+    shader_.destroy();
 }
\ No newline at end of file
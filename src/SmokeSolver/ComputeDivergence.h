@@ -7,7 +7,8 @@
 #include <string>
 #include "core/smokeField.h"
 #include "core/Buffer.h"
-#include "core/ComputeShader.h"
+#include "core/ShaderVariants.h"
+#include "SmokeSolver/SolverParams.h"
 
 class ComputeDivergence {
     public:
@@ -16,9 +17,14 @@ class ComputeDivergence {
                const SSBOBuffer& velocityBuf,
                const SSBOBuffer& wallBuf,
                const SSBOBuffer& divergenceBuf);
+    // Picks the shader variant for this step's parameters (see solverSpec);
+    // generic when `specialised` is false.
+    void specialise(const SolverParams& p, bool specialised);
+    ShaderVariants& variants() { return shader_; }
+
     void destroy();
 
     private:
-    ComputeShader shader_;
+    ShaderVariants shader_;
 
 };
\ No newline at end of file
@@ -7,8 +7,7 @@ void DiffuseSmoke::init() {
 void DiffuseSmoke::iterate(const VoxelDomain& domain,
                              const SSBOBuffer& srcSmokeDensityBuf,
                              SSBOBuffer& destSmokeDensityBuf,
-                             const SSBOBuffer& wallBuf,
-                             float dt) {
+                             const SSBOBuffer& wallBuf) {
     // 0 -> walls
     // 1 -> source density
     // 2 -> dest density
@@ -17,20 +16,16 @@ void DiffuseSmoke::iterate(const VoxelDomain& domain,
     srcSmokeDensityBuf.bindBase(1);
     destSmokeDensityBuf.bindBase(2);
 
+    // Parameters: the SolverParams block bound by SmokeSolver::step()
     shader_.use();
-    shader_.setIVec3("u_GridSize", domain.gridSize);
-    shader_.setFloat("u_CellSize", domain.voxelSize);
-    shader_.setFloat("u_SmokeDiffuseRate", smokeDiffuseRate_);
-    shader_.setFloat("u_Dt", dt);
 
     shader_.dispatch(domain.gridSize.x, domain.gridSize.y, domain.gridSize.z);
+}
 
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+void DiffuseSmoke::specialise(const SolverParams& p, bool specialised) {
+    shader_.select(specialised ? solverSpec(p, 0) : ShaderVariants::Spec());
 }
 
 void DiffuseSmoke::destroy() {
-    if (shader_.ID != 0) {
-        glDeleteProgram(shader_.ID);
-        shader_.ID = 0;
-    }
+    shader_.destroy();
 }
\ No newline at end of file
@@ -1,8 +1,9 @@
 #pragma once
 
 #include "core/Buffer.h"
-#include "core/ComputeShader.h"
+#include "core/ShaderVariants.h"
 #include "Voxel/VoxelDomain.h"
+#include "SmokeSolver/SolverParams.h"
 
 class DiffuseSmoke {
 public:
@@ -11,11 +12,17 @@ public:
     void iterate(const VoxelDomain& domain,
                  const SSBOBuffer& srcSmokeDensityBuf,
                  SSBOBuffer& destSmokeDensityBuf,
-                 const SSBOBuffer& wallBuf,
-                 float dt);
+                 const SSBOBuffer& wallBuf);
+
+    // Picks the shader variant for this step's parameters (see solverSpec);
+    // generic when `specialised` is false.
+    void specialise(const SolverParams& p, bool specialised);
+    ShaderVariants& variants() { return shader_; }
 
     void destroy();
 
+    void fillParams(SolverParams& p) const { p.smokeDiffuseRate = smokeDiffuseRate_; }
+
     void setSmokeDiffuseRate(float smokeDiffuseRate) {
         smokeDiffuseRate_ = smokeDiffuseRate;
     }
@@ -25,6 +32,6 @@ public:
     }
 
 private:
-    ComputeShader shader_;
+    ShaderVariants shader_;
     float smokeDiffuseRate_ = 0.05f;
 };
\ No newline at end of file
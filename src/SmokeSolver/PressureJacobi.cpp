@@ -16,23 +16,17 @@ void PressureJacobi::iterate(const VoxelDomain& domain,
     divergenceBuf.bindBase(2);
     destPressureBuf.bindBase(3);
 
+    // Parameters (incl. the vacuum sink): the SolverParams block bound once
+    // by SmokeSolver::step(), shared by every iteration.
     shader_.use();
-    shader_.setIVec3("u_GridSize", domain.gridSize);
-    shader_.setFloat("u_CellSize", domain.voxelSize);
-    shader_.setInt  ("u_VacuumActive",   vacuumActive);
-    shader_.setVec3 ("u_VacuumWorldPos", vacuumWorldPos);
-    shader_.setFloat("u_VacuumPressure", vacuumPressure);
-    shader_.setVec3 ("u_BoundsMin",      domain.boundsMin);
-    shader_.setFloat("u_VoxelSize",      domain.voxelSize);
 
     shader_.dispatch(domain.gridSize.x, domain.gridSize.y, domain.gridSize.z);
+}
 
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+void PressureJacobi::specialise(const SolverParams& p, bool specialised) {
+    shader_.select(specialised ? solverSpec(p, SolverSpec::Vacuum) : ShaderVariants::Spec());
 }
 
 void PressureJacobi::destroy() {
-    if (shader_.ID != 0) {
-        glDeleteProgram(shader_.ID);
-        shader_.ID = 0;
-    }
+    shader_.destroy();
 }
\ No newline at end of file
@@ -2,24 +2,26 @@
 
 
 #include "core/Buffer.h"
-#include "core/ComputeShader.h"
+#include "core/ShaderVariants.h"
+#include "SmokeSolver/SolverParams.h"
 #include "Voxel/VoxelDomain.h"
 
 class PressureJacobi {
     public:
-    int       vacuumActive   = 0;
-    glm::vec3 vacuumWorldPos = glm::vec3(0.0f);
-    float     vacuumPressure = -5.0f;
-
     void init();
     void iterate(const VoxelDomain& domain,
                const SSBOBuffer& srcPressureBuf,
                SSBOBuffer& destPressureBuf,
                const SSBOBuffer& wallBuf,
                const SSBOBuffer& divergenceBuf);
+    // Picks the shader variant for this step's parameters (see solverSpec);
+    // generic when `specialised` is false.
+    void specialise(const SolverParams& p, bool specialised);
+    ShaderVariants& variants() { return shader_; }
+
     void destroy();
 
     private:
-    ComputeShader shader_;
+    ShaderVariants shader_;
 
 };
@@ -8,8 +8,7 @@ void ProjectVelocity::iterate(const VoxelDomain& domain,
                               const SSBOBuffer& pressureBuf,
                               const SSBOBuffer& srcVelocityBuf,
                               SSBOBuffer& destVelocityBuf,
-                              const SSBOBuffer& wallBuf,
-                              float dt) {
+                              const SSBOBuffer& wallBuf) {
 
     // 0 -> pressure, 1 -> walls, 2 -> srcVelocity, 3 -> destVelocity
     pressureBuf.bindBase(0);
@@ -17,19 +16,16 @@ void ProjectVelocity::iterate(const VoxelDomain& domain,
     srcVelocityBuf.bindBase(2);
     destVelocityBuf.bindBase(3);
 
+    // Parameters: the SolverParams block bound by SmokeSolver::step()
     shader_.use();
-    shader_.setIVec3("u_GridSize", domain.gridSize);
-    shader_.setFloat("u_CellSize", domain.voxelSize);
-    shader_.setFloat("u_Dt", dt);
 
     shader_.dispatch(domain.gridSize.x, domain.gridSize.y, domain.gridSize.z);
+}
 
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+void ProjectVelocity::specialise(const SolverParams& p, bool specialised) {
+    shader_.select(specialised ? solverSpec(p, 0) : ShaderVariants::Spec());
 }
 
 void ProjectVelocity::destroy() {
-    if (shader_.ID != 0) {
-        glDeleteProgram(shader_.ID);
-        shader_.ID = 0;
-    }
+    shader_.destroy();
 }
\ No newline at end of file
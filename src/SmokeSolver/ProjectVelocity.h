@@ -1,7 +1,8 @@
 #pragma once 
 
 #include "core/Buffer.h"
-#include "core/ComputeShader.h"
+#include "core/ShaderVariants.h"
+#include "SmokeSolver/SolverParams.h"
 #include "Voxel/VoxelDomain.h"
 
 class ProjectVelocity {
@@ -11,11 +12,15 @@ class ProjectVelocity {
                  const SSBOBuffer& pressureBuf,
                  const SSBOBuffer& srcVelocityBuf,
                  SSBOBuffer& destVelocityBuf,
-                 const SSBOBuffer& wallBuf, 
-                 float dt);
+                 const SSBOBuffer& wallBuf);
+    // Picks the shader variant for this step's parameters (see solverSpec);
+    // generic when `specialised` is false.
+    void specialise(const SolverParams& p, bool specialised);
+    ShaderVariants& variants() { return shader_; }
+
     void destroy();
 
     private:
-    ComputeShader shader_;
+    ShaderVariants shader_;
 
 };
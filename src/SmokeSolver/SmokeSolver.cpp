@@ -1,4 +1,22 @@
 #include "SmokeSolver/SmokeSolver.h"
+#include "core/RenderGraph.h"
+#include "core/UniformBlock.h"
+#include "core/WorkgroupConfig.h"
+#include "core/WorkgroupTuner.h"
+
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// Workgroup sizes autotune() tries, at most 512 invocations each. The flat
+// ones suit short arenas such as the default 96x32x96.
+const glm::ivec3 WORKGROUP_CANDIDATES[] = {
+    {  8, 8, 8 }, {  8, 8, 4 }, {  8, 4, 8 }, {  4, 4, 4 }, { 16, 4, 4 }, { 16, 8, 4 },
+    { 16, 4, 8 }, { 32, 4, 2 }, { 32, 8, 1 }, { 64, 2, 2 }, { 16, 16, 2 },
+};
+
+} // namespace
 
 void SmokeSolver::init() {
     applyForces_.init();
@@ -20,91 +38,197 @@ void SmokeSolver::step(SmokeField& smoke, const SSBOBuffer& wallBuf, float dt) {
     // smoke.pressure1Curr = true;
     // Comment out when we want to try use the previous values for faster convergence
 
+    // Every kernel is a RenderGraph pass declaring the buffers it reads and
+    // writes; the graph places the barriers (the kernels issue none). The
+    // ping-pong swaps happen now, while recording, so each pass captures the
+    // buffers it will see when it runs. If the caller has a graph open
+    // (main), it executes these together with its own passes.
+    RenderGraph& graph = RenderGraph::instance();
+    const bool ownGraph = graph.begin();
+
+    // One parameter block for every kernel below, written once. Each pass
+    // binds it itself, since the graph may schedule other work in between.
+    // The vacuum timer ticks first so forces, pressure sink and suction in
+    // this step all see the same vacuum state.
+    applyForces_.tickVacuum(dt);
+
+    const SolverParams params = makeParams(smoke, dt);
+    const UniformBlock::Block block = UniformBlock::write(params);
+
+    // Variants for this grid and these toggles; a new combination compiles
+    // here, before any pass runs.
+    specialiseKernels(params);
+
+    const VoxelDomain* domain = &smoke.domain;
+    const SSBOBuffer*  walls  = &wallBuf;
+
     // advect velocity
-    advectVelocity_.iterate(
-        smoke.domain,
-        smoke.getSrcVelocity(),
-        smoke.getDestVelocity(),
-        wallBuf,
-        dt
-    );
-    smoke.swapVelocity();
+    {
+        const SSBOBuffer* src = &smoke.getSrcVelocity();
+        SSBOBuffer*       dst = &smoke.getDestVelocity();
+        graph.addPass("Advect Velocity")
+            .read(*src).read(wallBuf).write(*dst)
+            .exec([this, block, domain, src, dst, walls] {
+                UniformBlock::bind(block);
+                advectVelocity_.iterate(*domain, *src, *dst, *walls);
+            });
+        smoke.swapVelocity();
+    }
 
     // apply forces
-    applyForces_.dispatch(
-        smoke.domain,
-        smoke.getSrcVelocity(),
-        smoke.getDestVelocity(),
-        smoke.getSrcDensity(),
-        wallBuf,
-        dt
-    );
-    smoke.swapVelocity();
-    
+    {
+        const SSBOBuffer* src     = &smoke.getSrcVelocity();
+        const SSBOBuffer* dst     = &smoke.getDestVelocity();
+        const SSBOBuffer* density = &smoke.getSrcDensity();
+        graph.addPass("Apply Forces")
+            .read(*src).read(*density).read(wallBuf).write(*dst)
+            .exec([this, block, domain, src, dst, density, walls] {
+                UniformBlock::bind(block);
+                applyForces_.dispatch(*domain, *src, *dst, *density, *walls);
+            });
+        smoke.swapVelocity();
+    }
+
     // compute divergence
-    computeDivergence_.run(
-        smoke.domain,
-        smoke.getSrcVelocity(),
-        wallBuf,
-        smoke.divergence
-    );
-
-    // pressure solve — sync vacuum sink so each Jacobi iteration injects negative pressure
-    pressureJacobi_.vacuumActive   = applyForces_.vacuum.active ? 1 : 0;
-    pressureJacobi_.vacuumWorldPos = applyForces_.vacuum.worldPos;
-    pressureJacobi_.vacuumPressure = applyForces_.vacuum.pressure;
+    {
+        const SSBOBuffer* velocity   = &smoke.getSrcVelocity();
+        const SSBOBuffer* divergence = &smoke.divergence;
+        graph.addPass("Divergence")
+            .read(*velocity).read(wallBuf).write(*divergence)
+            .exec([this, block, domain, velocity, divergence, walls] {
+                UniformBlock::bind(block);
+                computeDivergence_.run(*domain, *velocity, *walls, *divergence);
+            });
+    }
 
+    // pressure solve — the vacuum sink in the block injects negative pressure every iteration
     for (int i=0; i < pressureIterations; i++) {
-        pressureJacobi_.iterate(
-            smoke.domain,
-            smoke.getSrcPressure(),
-            smoke.getDestPressure(),
-            wallBuf,
-            smoke.divergence
-        );
+        const SSBOBuffer* src        = &smoke.getSrcPressure();
+        SSBOBuffer*       dst        = &smoke.getDestPressure();
+        const SSBOBuffer* divergence = &smoke.divergence;
+        graph.addPass("Pressure Jacobi", "Pressure Solve")
+            .read(*src).read(*divergence).read(wallBuf).write(*dst)
+            .exec([this, block, domain, src, dst, divergence, walls] {
+                UniformBlock::bind(block);
+                pressureJacobi_.iterate(*domain, *src, *dst, *walls, *divergence);
+            });
         smoke.swapPressure();
     }
-    
+
     // project velocity
-    projectVelocity_.iterate(
-        smoke.domain,
-        smoke.getSrcPressure(),
-        smoke.getSrcVelocity(),
-        smoke.getDestVelocity(),
-        wallBuf,
-        dt
-    );
-    smoke.swapVelocity();
-
-    // advect smoke — sync vacuum state so the suction backtrace displacement
-    // is applied here (bypasses pressure projection which would cancel it)
-    advectSmoke_.vacuumActive   = applyForces_.vacuum.active ? 1 : 0;
-    advectSmoke_.vacuumWorldPos = applyForces_.vacuum.worldPos;
-    advectSmoke_.vacuumStrength = applyForces_.vacuum.strength;
-    advectSmoke_.vacuumRadius   = applyForces_.vacuum.radius;
+    {
+        const SSBOBuffer* pressure = &smoke.getSrcPressure();
+        const SSBOBuffer* src      = &smoke.getSrcVelocity();
+        SSBOBuffer*       dst      = &smoke.getDestVelocity();
+        graph.addPass("Project")
+            .read(*pressure).read(*src).read(wallBuf).write(*dst)
+            .exec([this, block, domain, pressure, src, dst, walls] {
+                UniformBlock::bind(block);
+                projectVelocity_.iterate(*domain, *pressure, *src, *dst, *walls);
+            });
+        smoke.swapVelocity();
+    }
+
+    // advect smoke — the vacuum suction backtrace displacement is applied
+    // here (bypasses pressure projection which would cancel it)
 
     if (advectSmokeEnabled) {
-        advectSmoke_.iterate(
-            smoke.domain,
-            smoke.getSrcVelocity(),
-            smoke.getSrcDensity(),
-            smoke.getDestDensity(),
-            wallBuf,
-            dt
-        );
+        const SSBOBuffer* velocity = &smoke.getSrcVelocity();
+        const SSBOBuffer* src      = &smoke.getSrcDensity();
+        SSBOBuffer*       dst      = &smoke.getDestDensity();
+        graph.addPass("Advect Smoke")
+            .read(*velocity).read(*src).read(wallBuf).write(*dst)
+            .exec([this, block, domain, velocity, src, dst, walls] {
+                UniformBlock::bind(block);
+                advectSmoke_.iterate(*domain, *velocity, *src, *dst, *walls);
+            });
         smoke.swapDensity();
     }
     
     // diffuse smoke
-    diffuseSmoke_.iterate(
-        smoke.domain,
-        smoke.getSrcDensity(),
-        smoke.getDestDensity(),
-        wallBuf,
-        dt
-    );
-    smoke.swapDensity();
+    {
+        const SSBOBuffer* src = &smoke.getSrcDensity();
+        SSBOBuffer*       dst = &smoke.getDestDensity();
+        graph.addPass("Diffuse")
+            .read(*src).read(wallBuf).write(*dst)
+            .exec([this, block, domain, src, dst, walls] {
+                UniformBlock::bind(block);
+                diffuseSmoke_.iterate(*domain, *src, *dst, *walls);
+            });
+        smoke.swapDensity();
+    }
+
+    if (ownGraph) graph.execute();
+}
+
+SolverParams SmokeSolver::makeParams(const SmokeField& smoke, float dt) const {
+    SolverParams params;
+    params.gridSize  = smoke.domain.gridSize;
+    params.cellSize  = smoke.domain.voxelSize;
+    params.voxelSize = smoke.domain.voxelSize;
+    params.boundsMin = smoke.domain.boundsMin;
+    params.dt        = dt;
+    applyForces_.fillParams(params);
+    advectVelocity_.fillParams(params);
+    advectSmoke_.fillParams(params);
+    diffuseSmoke_.fillParams(params);
+    return params;
+}
+
+void SmokeSolver::specialiseKernels(const SolverParams& params) {
+    applyForces_.specialise(params, specialisedKernels);
+    advectVelocity_.specialise(params, specialisedKernels);
+    advectSmoke_.specialise(params, specialisedKernels);
+    computeDivergence_.specialise(params, specialisedKernels);
+    pressureJacobi_.specialise(params, specialisedKernels);
+    projectVelocity_.specialise(params, specialisedKernels);
+    diffuseSmoke_.specialise(params, specialisedKernels);
+}
+
+void SmokeSolver::autotune(SmokeField& smoke, const SSBOBuffer& wallBuf, float dt) {
+    // The kernels run on the live field without swapping: only the scratch
+    // halves of the ping-pong buffers (and the divergence, rebuilt every
+    // step) are overwritten, so the simulation carries on unchanged.
+    struct Tunable {
+        ShaderVariants* variants;
+        void (*run)(SmokeSolver&, SmokeField&, const SSBOBuffer&);
+    };
+    const Tunable kernels[] = {
+        { &advectVelocity_.variants(), [](SmokeSolver& s, SmokeField& f, const SSBOBuffer& w) {
+              s.advectVelocity_.iterate(f.domain, f.getSrcVelocity(), f.getDestVelocity(), w); } },
+        { &applyForces_.variants(), [](SmokeSolver& s, SmokeField& f, const SSBOBuffer& w) {
+              s.applyForces_.dispatch(f.domain, f.getSrcVelocity(), f.getDestVelocity(),
+                                      f.getSrcDensity(), w); } },
+        { &computeDivergence_.variants(), [](SmokeSolver& s, SmokeField& f, const SSBOBuffer& w) {
+              s.computeDivergence_.run(f.domain, f.getSrcVelocity(), w, f.divergence); } },
+        { &pressureJacobi_.variants(), [](SmokeSolver& s, SmokeField& f, const SSBOBuffer& w) {
+              s.pressureJacobi_.iterate(f.domain, f.getSrcPressure(), f.getDestPressure(), w,
+                                        f.divergence); } },
+        { &projectVelocity_.variants(), [](SmokeSolver& s, SmokeField& f, const SSBOBuffer& w) {
+              s.projectVelocity_.iterate(f.domain, f.getSrcPressure(), f.getSrcVelocity(),
+                                         f.getDestVelocity(), w); } },
+        { &advectSmoke_.variants(), [](SmokeSolver& s, SmokeField& f, const SSBOBuffer& w) {
+              s.advectSmoke_.iterate(f.domain, f.getSrcVelocity(), f.getSrcDensity(),
+                                     f.getDestDensity(), w); } },
+        { &diffuseSmoke_.variants(), [](SmokeSolver& s, SmokeField& f, const SSBOBuffer& w) {
+              s.diffuseSmoke_.iterate(f.domain, f.getSrcDensity(), f.getDestDensity(), w); } },
+    };
+
+    const std::vector<glm::ivec3> candidates = WorkgroupTuner::supported(WORKGROUP_CANDIDATES);
+    const glm::ivec3 g = smoke.domain.gridSize;
+    std::cout << "[Autotune] " << candidates.size() << " workgroup sizes per kernel on a "
+              << g.x << "x" << g.y << "x" << g.z << " arena\n";
+
+    const SolverParams params = makeParams(smoke, dt);
+    UniformBlock::bind(params);
+    specialiseKernels(params);
 
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    for (const Tunable& k : kernels)
+        WorkgroupTuner::tune(*k.variants, candidates, query, [&] { k.run(*this, smoke, wallBuf); });
+    glDeleteQueries(1, &query);
+    WorkgroupConfig::instance().save();
 }
 
 void SmokeSolver::destroy() {
@@ -18,11 +18,19 @@ class SmokeSolver {
 public:
     int  pressureIterations = DEFAULT_ITER_COUNT;
     bool advectSmokeEnabled = true;
+    // Kernels compiled for the current grid size and toggles (ShaderVariants);
+    // off runs the generic kernels that read everything from the block.
+    bool specialisedKernels = true;
 
     void init();
     void step(SmokeField& smoke, const SSBOBuffer& wallBuf, float dt);
     void destroy();
 
+    // Times every kernel with each candidate workgroup size on `smoke`'s
+    // arena, keeps the fastest and saves them to WorkgroupConfig. Blocks on
+    // GPU queries; call between frames' GPU scopes, not inside one.
+    void autotune(SmokeField& smoke, const SSBOBuffer& wallBuf, float dt);
+
     // toggle between parabola buoyancy and heat buoyancy
     bool getUseHeatBuoyancy() {
         return applyForces_.buoyancyMode == 1;
@@ -113,6 +121,9 @@ public:
     }
 
 private:
+    SolverParams makeParams(const SmokeField& smoke, float dt) const;
+    void specialiseKernels(const SolverParams& params);
+
     ApplyForces applyForces_;
     AdvectVelocity advectVelocity_;
     AdvectSmoke advectSmoke_;
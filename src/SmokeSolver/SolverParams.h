@@ -0,0 +1,62 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "core/ShaderVariants.h"
+#include "core/UniformBlock.h"
+
+// Parameters of every solver kernel, as the std140 `SolverParams` block in
+// shaders/smoke/*.comp (binding UniformBlock::PASS_PARAMS_BINDING).
+// SmokeSolver::step() fills and uploads it once; all kernels of that step
+// read the same range. Keep the member order in sync with the shaders.
+struct SolverParams {
+    glm::ivec3 gridSize{0};              float cellSize = 1.0f;
+    glm::vec3  boundsMin{0.0f};          float dt = 0.0f;
+    glm::vec3  vacuumWorldPos{0.0f};     int   vacuumActive = 0;
+    float vacuumStrength   = 0.0f;
+    float vacuumRadius     = 0.0f;
+    float vacuumPressure   = 0.0f;
+    float voxelSize        = 1.0f;
+    float fallOff          = 1.0f;       // AdvectSmoke
+    float coolingRate      = 0.0f;       // AdvectVelocity
+    float smokeDiffuseRate = 0.0f;       // DiffuseSmoke
+    float gravityStrength  = 0.0f;       // ApplyForces from here on
+    float buoyancyStrength = 0.0f;
+    float densityLow       = 0.0f;
+    float densityHigh      = 0.0f;
+    float temperatureBuoyancyStrength = 0.0f;
+    float baroclinicStrength = 0.0f;
+    int   buoyancyMode     = 0;
+    float pad0_ = 0.0f, pad1_ = 0.0f;
+};
+
+STD140_OFFSET(SolverParams, cellSize,         12);
+STD140_OFFSET(SolverParams, boundsMin,        16);
+STD140_OFFSET(SolverParams, dt,               28);
+STD140_OFFSET(SolverParams, vacuumWorldPos,   32);
+STD140_OFFSET(SolverParams, vacuumActive,     44);
+STD140_OFFSET(SolverParams, vacuumStrength,   48);
+STD140_OFFSET(SolverParams, fallOff,          64);
+STD140_OFFSET(SolverParams, buoyancyStrength, 80);
+STD140_OFFSET(SolverParams, baroclinicStrength, 96);
+STD140_OFFSET(SolverParams, buoyancyMode,     100);
+STD140_SIZE(SolverParams, 112);
+
+// Shader variant of a solver kernel (ShaderVariants.h, the GRID_SIZE /
+// VACUUM_ACTIVE / BUOYANCY_MODE blocks in shaders/smoke/*.comp): the grid
+// size always, plus the runtime switches the kernel branches on. Values that
+// change every step stay in the block, so variants only change with the
+// arena or a toggle.
+namespace SolverSpec {
+enum Toggle { Vacuum = 1, BuoyancyMode = 2 };
+}
+
+inline ShaderVariants::Spec solverSpec(const SolverParams& p, int toggles) {
+    ShaderVariants::Spec spec;
+    spec.set("SMOKE_GRID_X", p.gridSize.x)
+        .set("SMOKE_GRID_Y", p.gridSize.y)
+        .set("SMOKE_GRID_Z", p.gridSize.z);
+    if (toggles & SolverSpec::Vacuum)       spec.set("SMOKE_VACUUM", p.vacuumActive);
+    if (toggles & SolverSpec::BuoyancyMode) spec.set("SMOKE_BUOYANCY_MODE", p.buoyancyMode);
+    return spec;
+}
@@ -12,7 +12,7 @@
 #include "VoxelDomain.h"
 #include "core/ComputeShader.h"
 #include "core/Buffer.h"
-#include "glVersion.h"
+#include "core/AsyncReadback.h"
 
 class Voxelizer {
 public:
@@ -109,7 +109,7 @@ public:
 
         // --- Setup and dispatch compute shader ---
         ComputeShader voxCS;
-        voxCS.setUp(getComputeSource());
+        voxCS.setUpFromFile("shaders/smoke/Voxelize.comp");
 
         triBuffer.bindBase(0);      // triangles
         staticVoxels.bindBase(1);   // output voxels
@@ -123,11 +123,8 @@ public:
         voxCS.dispatch((int)faces.size());
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
-        // Count filled voxels for debug
-        std::vector<int> data = staticVoxels.download<int>(domain.totalVoxels);
-        int filled = 0;
-        for (int v : data) if (v != 0) filled++;
-        std::cout << "Voxelizer: " << filled << " filled voxels" << std::endl;
+        // Count filled voxels for debug, once the readback lands (pollFilledCount)
+        filledReadback.request(staticVoxels, domain.totalVoxels * sizeof(int));
 
         // Cleanup
         triBuffer.destroy();
@@ -212,125 +209,24 @@ public:
                 << filled << " walls" << std::endl;
     }
 
+    // Print the filled-voxel count of the last voxelizeMesh() when its
+    // readback has arrived. Cheap no-op otherwise; call once per frame.
+    void pollFilledCount() {
+        if (!filledReadback.pending() || !filledReadback.ready()) return;
+        const int* data = filledReadback.data<int>();
+        int count  = (int)(filledReadback.bytes() / sizeof(int));
+        int filled = 0;
+        for (int i = 0; i < count; i++) if (data[i] != 0) filled++;
+        std::cout << "Voxelizer: " << filled << " filled voxels" << std::endl;
+    }
+
     void destroy() {
         staticVoxels.destroy();
+        filledReadback.destroy();
     }
 
 private:
-    const char* getComputeSource() {
-        return GLSL_VERSION_CORE 
-        R"(
-layout(local_size_x = 64) in;
-
-// Triangle buffer: each triangle is 3 x vec4
-struct Triangle { vec4 v0; vec4 v1; vec4 v2; };
-layout(std430, binding = 0) readonly buffer TriBuf { Triangle triangles[]; };
-
-// Output voxel grid
-layout(std430, binding = 1) buffer VoxelBuf { int voxels[]; };
-
-uniform ivec3 u_GridSize;
-uniform vec3  u_BoundsMin;
-uniform float u_VoxelSize;
-uniform int   u_TriCount;
-
-int flatIdx(ivec3 c) {
-    return c.x + c.y * u_GridSize.x + c.z * u_GridSize.x * u_GridSize.y;
-}
-
-// Project all 3 vertices and the AABB half-extents onto an axis,
-// return true if the intervals are separated (no overlap).
-bool separatedOnAxis(vec3 axis, vec3 v0, vec3 v1, vec3 v2, vec3 halfExt) {
-    float p0 = dot(axis, v0);
-    float p1 = dot(axis, v1);
-    float p2 = dot(axis, v2);
-    float triMin = min(min(p0, p1), p2);
-    float triMax = max(max(p0, p1), p2);
-
-    // AABB projection radius onto axis
-    float r = halfExt.x * abs(axis.x) + halfExt.y * abs(axis.y) + halfExt.z * abs(axis.z);
-
-    return (triMin > r || triMax < -r);
-}
-
-// 13-axis SAT test: triangle vs AABB centered at origin with half-extent h
-bool triIntersectsAABB(vec3 v0, vec3 v1, vec3 v2, vec3 h) {
-    // Triangle edges
-    vec3 e0 = v1 - v0;
-    vec3 e1 = v2 - v1;
-    vec3 e2 = v0 - v2;
-
-    // 9 cross-product axes (edge x cardinal)
-    if (separatedOnAxis(vec3(0, -e0.z, e0.y), v0, v1, v2, h)) return false;
-    if (separatedOnAxis(vec3(0, -e1.z, e1.y), v0, v1, v2, h)) return false;
-    if (separatedOnAxis(vec3(0, -e2.z, e2.y), v0, v1, v2, h)) return false;
-    if (separatedOnAxis(vec3(e0.z, 0, -e0.x), v0, v1, v2, h)) return false;
-    if (separatedOnAxis(vec3(e1.z, 0, -e1.x), v0, v1, v2, h)) return false;
-    if (separatedOnAxis(vec3(e2.z, 0, -e2.x), v0, v1, v2, h)) return false;
-    if (separatedOnAxis(vec3(-e0.y, e0.x, 0), v0, v1, v2, h)) return false;
-    if (separatedOnAxis(vec3(-e1.y, e1.x, 0), v0, v1, v2, h)) return false;
-    if (separatedOnAxis(vec3(-e2.y, e2.x, 0), v0, v1, v2, h)) return false;
-
-    // 3 AABB face normals (cardinal axes)
-    float triMinX = min(min(v0.x, v1.x), v2.x);
-    float triMaxX = max(max(v0.x, v1.x), v2.x);
-    if (triMinX > h.x || triMaxX < -h.x) return false;
-
-    float triMinY = min(min(v0.y, v1.y), v2.y);
-    float triMaxY = max(max(v0.y, v1.y), v2.y);
-    if (triMinY > h.y || triMaxY < -h.y) return false;
-
-    float triMinZ = min(min(v0.z, v1.z), v2.z);
-    float triMaxZ = max(max(v0.z, v1.z), v2.z);
-    if (triMinZ > h.z || triMaxZ < -h.z) return false;
-
-    // 1 triangle face normal
-    vec3 triNormal = cross(e0, e1);
-    if (separatedOnAxis(triNormal, v0, v1, v2, h)) return false;
-
-    return true;
-}
-
-void main() {
-    uint triIdx = gl_GlobalInvocationID.x;
-    if (triIdx >= u_TriCount) return;
-
-    vec3 v0 = triangles[triIdx].v0.xyz;
-    vec3 v1 = triangles[triIdx].v1.xyz;
-    vec3 v2 = triangles[triIdx].v2.xyz;
-
-    // Compute triangle AABB in grid coordinates
-    vec3 triMin = min(min(v0, v1), v2);
-    vec3 triMax = max(max(v0, v1), v2);
-
-    ivec3 gMin = ivec3(floor((triMin - u_BoundsMin) / u_VoxelSize));
-    ivec3 gMax = ivec3(floor((triMax - u_BoundsMin) / u_VoxelSize));
-
-    gMin = max(gMin, ivec3(0));
-    gMax = min(gMax, u_GridSize - 1);
-
-    vec3 halfExt = vec3(u_VoxelSize * 0.5);
-
-    // Test each voxel in the triangle's AABB
-    for (int z = gMin.z; z <= gMax.z; z++)
-    for (int y = gMin.y; y <= gMax.y; y++)
-    for (int x = gMin.x; x <= gMax.x; x++) {
-        // Voxel center in world space
-        vec3 center = u_BoundsMin + (vec3(x, y, z) + 0.5) * u_VoxelSize;
-
-        // Translate triangle to voxel-centered coordinates
-        vec3 tv0 = v0 - center;
-        vec3 tv1 = v1 - center;
-        vec3 tv2 = v2 - center;
-
-        if (triIntersectsAABB(tv0, tv1, tv2, halfExt)) {
-            int idx = flatIdx(ivec3(x, y, z));
-            atomicOr(voxels[idx], 1);
-        }
-    }
-}
-)";
-    }
+    AsyncReadback filledReadback;
 };
 
 #endif // VOXELIZER_H
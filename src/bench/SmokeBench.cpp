@@ -0,0 +1,514 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/FrameRingBuffer.h"
+#include "core/GpuProfiler.h"
+#include "core/Headless.h"
+#include "core/ComputeShader.h"
+#include "core/ProgramCache.h"
+#include "core/ShaderLibrary.h"
+#include "core/ShaderManager.h"
+#include "core/UniformBlock.h"
+#include "core/WorkgroupConfig.h"
+#include "core/smokeField.h"
+#include "SmokeSolver/SmokeSolver.h"
+#include "Voxel/Voxelizer.h"
+
+// smoke_bench: solver throughput across grid sizes.
+//
+//   smoke_bench [--reps N] [--warmup N] [--out FILE]
+//               [--baseline FILE] [--threshold PCT]
+//   smoke_bench --shaders
+//
+// For every grid in the sweep it builds Voxelizer::generateTestScene, puts a
+// block of smoke in the middle of a SmokeField, then times each solver kernel
+// on its own (one dispatch per sample) and the full SmokeSolver::step, with
+// a blocking GL_TIME_ELAPSED query per sample. The median is reported as ms,
+// voxels/s and effective GB/s, printed as a table and written as JSON.
+//
+// Effective GB/s counts the compulsory traffic only: every buffer a kernel
+// touches, read or written once per voxel (see Kernel::bytesPerVoxel).
+// Neighbour taps that hit cache are not counted, so this is a lower bound on
+// real DRAM traffic and is meant for comparing runs, not for roofline plots.
+//
+// --baseline compares against a JSON file written by an earlier run; any
+// (grid, kernel) more than --threshold percent slower fails the run (exit 1).
+// --shaders instead times startup shader builds: every shaders/smoke/*.comp
+// built from source with the status checked right after each link (the
+// serial baseline) and with all programs submitted before any check
+// (ShaderManager::deferred, plus the driver's parallel compile if it has one).
+//
+// Run from the repository root: the kernels load shaders/smoke/*.comp.
+
+namespace {
+
+struct Options {
+    int         reps      = 50;
+    int         warmup    = 10;
+    std::string outPath   = "smoke_bench.json";
+    std::string baseline;
+    float       threshold = 10.0f;   // percent
+    bool        shaders   = false;   // --shaders: time shader builds only
+};
+
+struct Grid { int x, y, z; };
+
+const Grid GRIDS[] = {
+    {  64, 64,  64 },
+    {  96, 32,  96 },
+    { 128, 128, 128 },
+    { 192, 192, 192 },
+    { 256, 64,  256 },
+};
+
+constexpr float VOXEL_SIZE = 0.15f;
+constexpr float STEP_DT    = 1.0f / 60.0f;
+
+struct Result {
+    std::string grid;
+    std::string kernel;
+    int    voxels = 0;
+    double ms     = 0.0;
+    double voxelsPerSec = 0.0;
+    double gbPerSec     = 0.0;   // 0 for the full step (mixed kernels)
+};
+
+void printUsage() {
+    std::cout << "Usage: smoke_bench [--reps N] [--warmup N] [--out FILE]\n"
+                 "                   [--baseline FILE] [--threshold PCT]\n"
+                 "       smoke_bench --shaders\n";
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool ok = true;
+        if (!std::strcmp(arg, "--shaders")) {
+            opt.shaders = true;
+            continue;
+        }
+        if (!val) ok = false;
+        else if (!std::strcmp(arg, "--reps"))      opt.reps      = std::atoi(val);
+        else if (!std::strcmp(arg, "--warmup"))    opt.warmup    = std::atoi(val);
+        else if (!std::strcmp(arg, "--out"))       opt.outPath   = val;
+        else if (!std::strcmp(arg, "--baseline"))  opt.baseline  = val;
+        else if (!std::strcmp(arg, "--threshold")) opt.threshold = (float)std::atof(val);
+        else ok = false;
+
+        if (!ok || opt.reps <= 0 || opt.warmup < 0 || opt.threshold < 0.0f) {
+            std::cerr << "Bad argument: " << arg << (val ? std::string(" ") + val : "") << "\n";
+            printUsage();
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+void setContextHints() {
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+#endif
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+}
+
+// Median GPU time of `reps` calls to `body`, after `warmup` untimed calls.
+// Each sample is its own query and is read back right away: the bench does
+// not care about stalls, only about not overlapping samples.
+template<typename F>
+double timeMedianMs(int warmup, int reps, F&& body) {
+    FrameRingBuffer& ring = FrameRingBuffer::instance();
+    for (int i = 0; i < warmup; i++) {
+        ring.beginFrame();
+        body();
+        ring.endFrame();
+    }
+    glFinish();
+
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    std::vector<double> samples((size_t)reps);
+    for (int i = 0; i < reps; i++) {
+        ring.beginFrame();
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        body();
+        glEndQuery(GL_TIME_ELAPSED);
+        ring.endFrame();
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+        samples[i] = (double)ns * 1e-6;
+    }
+    glDeleteQueries(1, &query);
+
+    std::nth_element(samples.begin(), samples.begin() + reps / 2, samples.end());
+    return samples[reps / 2];
+}
+
+// Density in a centred box (a quarter of each axis), so advection and
+// diffusion see real data rather than an all-zero field.
+void seedSmoke(SmokeField& smoke) {
+    const VoxelDomain& d = smoke.domain;
+    std::vector<float> density((size_t)d.totalVoxels, 0.0f);
+    glm::ivec3 lo = d.gridSize * 3 / 8, hi = d.gridSize * 5 / 8;
+    for (int z = lo.z; z < hi.z; z++)
+    for (int y = lo.y; y < hi.y; y++)
+    for (int x = lo.x; x < hi.x; x++)
+        density[d.flatten(x, y, z)] = 1.0f;
+    smoke.density1.upload(density);
+    smoke.density2.upload(density);
+}
+
+// The solver's kernels driven one at a time, with the same parameter block
+// and shader variants SmokeSolver::step() would use.
+struct Kernels {
+    ApplyForces       applyForces;
+    AdvectVelocity    advectVelocity;
+    AdvectSmoke       advectSmoke;
+    ComputeDivergence divergence;
+    PressureJacobi    jacobi;
+    ProjectVelocity   project;
+    DiffuseSmoke      diffuse;
+
+    void init() {
+        applyForces.init();
+        advectVelocity.init();
+        advectSmoke.init();
+        divergence.init();
+        jacobi.init();
+        project.init();
+        diffuse.init();
+    }
+
+    void bindParams(const VoxelDomain& d) {
+        SolverParams params;
+        params.gridSize  = d.gridSize;
+        params.cellSize  = d.voxelSize;
+        params.voxelSize = d.voxelSize;
+        params.boundsMin = d.boundsMin;
+        params.dt        = STEP_DT;
+        applyForces.fillParams(params);
+        advectVelocity.fillParams(params);
+        advectSmoke.fillParams(params);
+        diffuse.fillParams(params);
+        UniformBlock::bind(params);
+
+        applyForces.specialise(params, true);
+        advectVelocity.specialise(params, true);
+        advectSmoke.specialise(params, true);
+        divergence.specialise(params, true);
+        jacobi.specialise(params, true);
+        project.specialise(params, true);
+        diffuse.specialise(params, true);
+    }
+
+    void destroy() {
+        applyForces.destroy();
+        advectVelocity.destroy();
+        advectSmoke.destroy();
+        divergence.destroy();
+        jacobi.destroy();
+        project.destroy();
+        diffuse.destroy();
+    }
+};
+
+std::string gridName(const Grid& g) {
+    return std::to_string(g.x) + "x" + std::to_string(g.y) + "x" + std::to_string(g.z);
+}
+
+void benchGrid(const Grid& g, const Options& opt, Kernels& k, SmokeSolver& solver,
+               std::vector<Result>& results) {
+    Voxelizer voxelizer;
+    voxelizer.generateTestScene(VOXEL_SIZE, g.x, g.y, g.z);
+    SmokeField smoke;
+    smoke.init(voxelizer.domain);
+    seedSmoke(smoke);
+
+    const VoxelDomain& d = voxelizer.domain;
+    const SSBOBuffer& walls = voxelizer.staticVoxels;
+    const std::string name = gridName(g);
+
+    constexpr int F = sizeof(float), V = sizeof(glm::vec4), W = sizeof(int);
+
+    struct Kernel {
+        const char* name;
+        int bytesPerVoxel;   // compulsory reads + writes
+        void (*run)(Kernels&, const VoxelDomain&, SmokeField&, const SSBOBuffer&);
+    };
+    // Buffers are named directly, never swapped, so every sample runs the
+    // same dispatch on the same inputs. Captureless lambdas keep the table
+    // a plain array.
+    const Kernel kernels[] = {
+        { "AdvectVelocity", V + W + V,
+          [](Kernels& k, const VoxelDomain& d, SmokeField& s, const SSBOBuffer& w) {
+              k.advectVelocity.iterate(d, s.velocity1, s.velocity2, w); } },
+        { "ApplyForces", V + V + F + W,
+          [](Kernels& k, const VoxelDomain& d, SmokeField& s, const SSBOBuffer& w) {
+              k.applyForces.dispatch(d, s.velocity1, s.velocity2, s.density1, w); } },
+        { "ComputeDivergence", V + W + F,
+          [](Kernels& k, const VoxelDomain& d, SmokeField& s, const SSBOBuffer& w) {
+              k.divergence.run(d, s.velocity1, w, s.divergence); } },
+        { "PressureJacobi", F + W + F + F,
+          [](Kernels& k, const VoxelDomain& d, SmokeField& s, const SSBOBuffer& w) {
+              k.jacobi.iterate(d, s.pressure1, s.pressure2, w, s.divergence); } },
+        { "ProjectVelocity", F + V + V + W,
+          [](Kernels& k, const VoxelDomain& d, SmokeField& s, const SSBOBuffer& w) {
+              k.project.iterate(d, s.pressure1, s.velocity1, s.velocity2, w); } },
+        { "AdvectSmoke", V + F + F + W,
+          [](Kernels& k, const VoxelDomain& d, SmokeField& s, const SSBOBuffer& w) {
+              k.advectSmoke.iterate(d, s.velocity1, s.density1, s.density2, w); } },
+        { "DiffuseSmoke", F + F + W,
+          [](Kernels& k, const VoxelDomain& d, SmokeField& s, const SSBOBuffer& w) {
+              k.diffuse.iterate(d, s.density1, s.density2, w); } },
+    };
+
+    for (const Kernel& kernel : kernels) {
+        double ms = timeMedianMs(opt.warmup, opt.reps, [&] {
+            k.bindParams(d);
+            kernel.run(k, d, smoke, walls);
+        });
+        Result r;
+        r.grid   = name;
+        r.kernel = kernel.name;
+        r.voxels = d.totalVoxels;
+        r.ms     = ms;
+        r.voxelsPerSec = d.totalVoxels / (ms * 1e-3);
+        r.gbPerSec     = (double)d.totalVoxels * kernel.bytesPerVoxel / (ms * 1e-3) * 1e-9;
+        results.push_back(r);
+    }
+
+    // The full step swaps buffers as it goes; the field keeps evolving from
+    // the seeded state, which is what a real frame does too.
+    double ms = timeMedianMs(opt.warmup, opt.reps, [&] {
+        solver.step(smoke, walls, STEP_DT);
+    });
+    Result r;
+    r.grid   = name;
+    r.kernel = "SmokeSolver::step";
+    r.voxels = d.totalVoxels;
+    r.ms     = ms;
+    r.voxelsPerSec = d.totalVoxels / (ms * 1e-3);
+    results.push_back(r);
+
+    smoke.destroy();
+    voxelizer.destroy();
+}
+
+void printTable(const std::vector<Result>& results) {
+    std::printf("%-12s %-20s %10s %14s %10s\n", "grid", "kernel", "ms", "Mvoxels/s", "GB/s");
+    for (const Result& r : results)
+        std::printf("%-12s %-20s %10.4f %14.1f %10.1f\n", r.grid.c_str(), r.kernel.c_str(),
+                    r.ms, r.voxelsPerSec * 1e-6, r.gbPerSec);
+}
+
+// One result object per line, so readBaseline() can stay a line scanner.
+bool writeJSON(const std::string& path, const std::vector<Result>& results,
+               const Options& opt, const char* renderer) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "[smoke_bench] Cannot write " << path << "\n";
+        return false;
+    }
+    out << "{\n";
+    out << "  \"renderer\": \"" << renderer << "\",\n";
+    out << "  \"reps\": " << opt.reps << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "    {\"grid\": \"%s\", \"kernel\": \"%s\", \"voxels\": %d, \"ms\": %.6f, "
+                      "\"voxelsPerSec\": %.6e, \"gbPerSec\": %.3f}%s\n",
+                      r.grid.c_str(), r.kernel.c_str(), r.voxels, r.ms,
+                      r.voxelsPerSec, r.gbPerSec, i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+    std::cout << "[smoke_bench] Wrote " << results.size() << " results to " << path << "\n";
+    return true;
+}
+
+// Wall time to build `sources` from scratch and check every program.
+// `salt` goes in as a #define so that no round can reuse a program the
+// driver cached from an earlier one.
+double buildAllMs(const std::vector<std::string>& sources, const std::vector<std::string>& labels,
+                  bool deferred, int salt) {
+    std::string define = "#define SMOKE_BENCH_SALT " + std::to_string(salt) + "\n";
+    std::vector<std::string> salted;
+    for (const std::string& s : sources) salted.push_back(ComputeShader::injectDefines(s, define));
+
+    ShaderManager::instance().deferred = deferred;
+    std::vector<ComputeShader> shaders(salted.size());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < salted.size(); i++) shaders[i].setUp(salted[i].c_str(), labels[i]);
+    for (const ComputeShader& cs : shaders) cs.ready();
+    double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    for (const ComputeShader& cs : shaders) glDeleteProgram(cs.ID);
+    return ms;
+}
+
+// --shaders: serial vs deferred builds of every shaders/smoke/*.comp,
+// interleaved over a few rounds; the best round of each is reported.
+bool benchShaderBuilds() {
+    ShaderLibrary& library = ShaderLibrary::instance();
+    std::vector<std::string> labels = library.list("shaders/smoke", ".comp"), sources;
+    if (labels.empty()) {
+        std::cerr << "[smoke_bench] No shaders in shaders/smoke (run from the repo root)\n";
+        return false;
+    }
+    for (const std::string& path : labels) sources.push_back(library.load(path));
+
+    constexpr int ROUNDS = 3;
+    double serial = 1e30, deferred = 1e30;
+    for (int r = 0; r < ROUNDS; r++) {
+        serial   = std::min(serial,   buildAllMs(sources, labels, false, 2 * r));
+        deferred = std::min(deferred, buildAllMs(sources, labels, true,  2 * r + 1));
+    }
+    std::printf("\nShader builds, %zu programs (best of %d):\n", sources.size(), ROUNDS);
+    std::printf("  serial (check after each link)  %9.1f ms\n", serial);
+    std::printf("  deferred checks, parallel %-3s   %9.1f ms  (%.2fx)\n",
+                ShaderManager::instance().parallel ? "on" : "off", deferred, serial / deferred);
+    return true;
+}
+
+// Value of "key": in `line`, quotes stripped; empty if absent.
+std::string field(const std::string& line, const char* key) {
+    std::string tag = std::string("\"") + key + "\":";
+    size_t at = line.find(tag);
+    if (at == std::string::npos) return {};
+    at = line.find_first_not_of(" \"", at + tag.size());
+    if (at == std::string::npos) return {};
+    size_t end = line.find_first_of("\",}", at);
+    return line.substr(at, end - at);
+}
+
+// Reads the files writeJSON() produces (one result per line); not a general
+// JSON parser.
+bool readBaseline(const std::string& path, std::vector<Result>& out) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "[smoke_bench] Cannot read baseline " << path << "\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        Result r;
+        r.grid   = field(line, "grid");
+        r.kernel = field(line, "kernel");
+        std::string ms = field(line, "ms");
+        if (r.grid.empty() || r.kernel.empty() || ms.empty()) continue;
+        r.ms = std::atof(ms.c_str());
+        out.push_back(r);
+    }
+    return true;
+}
+
+// False if any (grid, kernel) present in both runs got slower than the
+// threshold allows. Entries missing on either side are listed, not failed.
+bool compareBaseline(const std::vector<Result>& current, const std::vector<Result>& baseline,
+                     float thresholdPct) {
+    int regressions = 0;
+    std::printf("\nBaseline comparison (threshold %.1f%%):\n", thresholdPct);
+    for (const Result& cur : current) {
+        const Result* base = nullptr;
+        for (const Result& b : baseline)
+            if (b.grid == cur.grid && b.kernel == cur.kernel) { base = &b; break; }
+        if (!base || base->ms <= 0.0) {
+            std::printf("  %-12s %-20s  no baseline\n", cur.grid.c_str(), cur.kernel.c_str());
+            continue;
+        }
+        double deltaPct = (cur.ms / base->ms - 1.0) * 100.0;
+        bool regressed = deltaPct > thresholdPct;
+        if (regressed) regressions++;
+        std::printf("  %-12s %-20s %10.4f -> %10.4f ms  %+7.1f%%%s\n", cur.grid.c_str(),
+                    cur.kernel.c_str(), base->ms, cur.ms, deltaPct, regressed ? "  REGRESSION" : "");
+    }
+    if (regressions) {
+        std::cerr << "[smoke_bench] " << regressions << " regression(s) over "
+                  << thresholdPct << "%\n";
+        return false;
+    }
+    std::cout << "[smoke_bench] No regressions\n";
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) return 2;
+
+    GLFWwindow* window = Headless::createWindow(64, 64, "smoke_bench", setContextHints);
+    if (!window) {
+        std::cout << "Failed to create GLFW window\n";
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD\n";
+        return -1;
+    }
+
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    std::cout << "Renderer: " << renderer << "\n";
+
+    ShaderManager::instance().init((GLADloadproc)glfwGetProcAddress);
+    if (opt.shaders) {
+        // Before ProgramCache::init, so every build really compiles.
+        bool ok = benchShaderBuilds();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return ok ? 0 : 1;
+    }
+
+    ProgramCache::instance().init("shader_cache");
+    WorkgroupConfig::instance().load("workgroup_sizes.txt");   // as the app runs them
+    FrameRingBuffer::instance().init();
+    // step() instruments its passes with GL_TIME_ELAPSED queries, which would
+    // collide with the bench's own; the bench does the timing here.
+    GpuProfiler::instance().enabled = false;
+
+    Kernels kernels;
+    kernels.init();
+    SmokeSolver solver;
+    solver.init();
+
+    std::vector<Result> results;
+    for (const Grid& g : GRIDS)
+        benchGrid(g, opt, kernels, solver, results);
+
+    printTable(results);
+    bool ok = writeJSON(opt.outPath, results, opt, renderer);
+
+    if (!opt.baseline.empty()) {
+        std::vector<Result> baseline;
+        ok = readBaseline(opt.baseline, baseline) && compareBaseline(results, baseline, opt.threshold) && ok;
+    }
+
+    solver.destroy();
+    kernels.destroy();
+    FrameRingBuffer::instance().destroy();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Steady-state heap allocation check (SMOKE_ALLOC_CHECK builds).
+//
+// With SMOKE_ALLOC_CHECK defined, the global operator new/delete below count
+// every C++ heap allocation, and main brackets each frame with
+// beginFrame()/endFrame(). Once `warmupFrames` have passed (pass scopes,
+// query pools and readback staging are sized by then), any frame that still
+// allocates is reported and the check fails; main returns non-zero at exit.
+//
+// Frames that legitimately allocate (arena rebuild, a landing wall readback
+// of a new size, a trace capture or profiler recording) call exemptFrame().
+// Only operator new is seen: driver, GLFW and ImGui (malloc) allocations are
+// not counted.
+//
+// Without the define nothing is replaced and every call is a no-op.
+//
+// Include this header from one translation unit only (main.cpp): with the
+// define it holds the replacement operator new/delete definitions, and a
+// second copy would not link.
+class AllocCheck {
+public:
+    uint64_t warmupFrames = 120;
+
+    static AllocCheck& instance() {
+        static AllocCheck check;
+        return check;
+    }
+
+    static std::atomic<uint64_t>& counter() {
+        static std::atomic<uint64_t> count{ 0 };
+        return count;
+    }
+
+    static constexpr bool enabled() {
+#ifdef SMOKE_ALLOC_CHECK
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void beginFrame() {
+        if (!enabled()) return;
+        frameStart = counter().load(std::memory_order_relaxed);
+        exempt = false;
+    }
+
+    void exemptFrame() { exempt = true; }
+
+    void endFrame() {
+        if (!enabled()) return;
+        lastFrameAllocs = counter().load(std::memory_order_relaxed) - frameStart;
+        if (++frames <= warmupFrames || exempt || lastFrameAllocs == 0) return;
+        failedFrames++;
+        if (failedFrames <= MAX_REPORTS)
+            std::cerr << "[AllocCheck] Frame " << frames << ": " << lastFrameAllocs
+                      << " heap allocation(s) in steady state\n";
+    }
+
+    uint64_t lastFrame() const { return lastFrameAllocs; }
+    uint64_t failures()  const { return failedFrames; }
+
+    // Prints the verdict; false if any steady-state frame allocated.
+    bool report() const {
+        if (!enabled()) return true;
+        if (frames <= warmupFrames) {
+            std::cout << "[AllocCheck] Only " << frames << " frames, no steady state reached\n";
+            return true;
+        }
+        if (failedFrames == 0) {
+            std::cout << "[AllocCheck] PASSED: " << frames - warmupFrames
+                      << " steady-state frames without heap allocations\n";
+            return true;
+        }
+        std::cerr << "[AllocCheck] FAILED: " << failedFrames << " of " << frames - warmupFrames
+                  << " steady-state frames allocated\n";
+        return false;
+    }
+
+private:
+    static constexpr uint64_t MAX_REPORTS = 10;
+
+    uint64_t frameStart      = 0;
+    uint64_t lastFrameAllocs = 0;
+    uint64_t frames          = 0;
+    uint64_t failedFrames    = 0;
+    bool     exempt          = false;
+
+    AllocCheck() = default;
+};
+
+#ifdef SMOKE_ALLOC_CHECK
+// Replacement global allocation functions (see above: one translation unit
+// only). The array and nothrow forms forward to the counting operator new;
+// the aligned (std::align_val_t) forms are not replaced and not counted.
+void* operator new(std::size_t bytes) {
+    AllocCheck::counter().fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(bytes ? bytes : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t bytes) { return ::operator new(bytes); }
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept {
+    try {
+        return ::operator new(bytes);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept {
+    return ::operator new(bytes, std::nothrow);
+}
+void  operator delete(void* p) noexcept { std::free(p); }
+void  operator delete[](void* p) noexcept { std::free(p); }
+void  operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void  operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void  operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void  operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+#endif
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "core/Buffer.h"
+
+// Non-blocking GPU -> CPU copy of an SSBO range.
+//
+// request() queues a glCopyBufferSubData into a persistently mapped staging
+// buffer (glBufferStorage, MAP_READ | PERSISTENT | COHERENT) followed by a
+// glFenceSync and returns immediately. ready() polls the fence with a zero
+// timeout; wait() blocks on it. Once signalled, data<T>() points straight at
+// the mapped bytes, no further GL call needed.
+//
+// Without glBufferStorage (hasBufferStorage(): GL 4.4) the staging buffer is
+// plain glBufferData storage, mapped for reading once the copy has landed and
+// unmapped by the next request(); data<T>() works the same.
+//
+// One request in flight per object; requesting again replaces the old one.
+// The staging buffer only grows. Unlike SSBOBuffer::download() nothing here
+// drains the pipeline, so call sites that can use the result a frame or more
+// later should prefer it.
+class AsyncReadback {
+public:
+    // Copy `bytes` from src (starting at srcOffset) once the GPU gets there.
+    void request(const SSBOBuffer& src, size_t bytes, size_t srcOffset = 0) {
+        if (bytes == 0) return;
+        ensureCapacity(bytes);
+        releaseFence();
+        if (!persistent) unmap();   // the copy cannot write a mapped buffer
+
+        // Shader writes to src must land before the copy reads it.
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glBindBuffer(GL_COPY_READ_BUFFER,  src.ID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, staging);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            (GLintptr)srcOffset, 0, (GLsizeiptr)bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER,  0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        fence     = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        sizeBytes = bytes;
+        complete  = false;
+        // Make sure the fence reaches the GPU even if nobody waits on it.
+        glFlush();
+    }
+
+    bool pending() const { return fence != nullptr && !complete; }
+    bool hasData() const { return complete; }
+
+    // Non-blocking; true once the copy has landed.
+    bool ready() {
+        if (complete) return true;
+        if (!fence) return false;
+        GLenum r = glClientWaitSync(fence, 0, 0);
+        if (r == GL_ALREADY_SIGNALED || r == GL_CONDITION_SATISFIED) land();
+        return complete;
+    }
+
+    // Block until the copy lands (or timeoutNs passes). False if nothing was
+    // requested, on timeout or on error.
+    bool wait(uint64_t timeoutNs = UINT64_MAX) {
+        if (complete) return true;
+        if (!fence) return false;
+        GLenum r = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+        if (r == GL_ALREADY_SIGNALED || r == GL_CONDITION_SATISFIED) land();
+        return complete;
+    }
+
+    // Valid only while hasData(); invalidated by the next request().
+    template<typename T>
+    const T* data() const { return static_cast<const T*>(mapped); }
+
+    size_t bytes() const { return sizeBytes; }
+
+    template<typename T>
+    void copyTo(std::vector<T>& out) const {
+        out.resize(sizeBytes / sizeof(T));
+        std::memcpy(out.data(), mapped, out.size() * sizeof(T));
+    }
+
+    void destroy() {
+        releaseFence();
+        if (staging) {
+            unmap();
+            glDeleteBuffers(1, &staging);
+        }
+        staging   = 0;
+        capacity  = 0;
+        sizeBytes = 0;
+        complete  = false;
+    }
+
+private:
+    GLuint staging    = 0;
+    void*  mapped     = nullptr;
+    size_t capacity   = 0;
+    size_t sizeBytes  = 0;
+    GLsync fence      = nullptr;
+    bool   complete   = false;
+    bool   persistent = false;   // glBufferStorage staging, mapped for its lifetime
+
+    void ensureCapacity(size_t bytes) {
+        if (bytes <= capacity) return;
+        destroy();
+        glGenBuffers(1, &staging);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, staging);
+        persistent = hasBufferStorage();
+        if (persistent) {
+            const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)bytes, nullptr, flags);
+            mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)bytes, flags);
+        } else {
+            glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)bytes, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        capacity = bytes;
+    }
+
+    // The copy has landed; without persistent mapping, map it now.
+    void land() {
+        releaseFence();
+        complete = true;
+        if (persistent || mapped) return;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, staging);
+        mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)sizeBytes, GL_MAP_READ_BIT);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void unmap() {
+        if (!mapped) return;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, staging);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        mapped = nullptr;
+    }
+
+    void releaseFence() {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+};
@@ -6,6 +6,15 @@
 #include <vector>
 #include <cstring>
 
+#include "core/FrameTrace.h"
+
+// glBufferStorage is core only from GL 4.4 (ARB_buffer_storage) and the
+// contexts here ask for 4.3 (4.1 on macOS). glad loads the entry point only
+// when the driver reports 4.4, so check this before calling it.
+inline bool hasBufferStorage() {
+    return GLAD_GL_VERSION_4_4 && glBufferStorage != nullptr;
+}
+
 class SSBOBuffer {
 public:
     unsigned int ID = 0;
@@ -30,12 +39,23 @@ public:
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
     }
 
+    // Blocking: waits for the GPU to finish writing the buffer.
+    // Prefer AsyncReadback (core/AsyncReadback.h) when the data can wait.
+    // The `out` overload reuses the caller's storage, so repeated downloads
+    // of the same size do not allocate.
     template<typename T>
-    std::vector<T> download(size_t count) const {
-        std::vector<T> result(count);
+    void download(std::vector<T>& out, size_t count) const {
+        CpuTraceScope scope("SSBO download (glGetBufferSubData)");
+        out.resize(count);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
-        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(T), result.data());
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(T), out.data());
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    template<typename T>
+    std::vector<T> download(size_t count) const {
+        std::vector<T> result;
+        download(result, count);
         return result;
     }
 
@@ -7,71 +7,103 @@
 #include <iostream>
 #include <string>
 #include "core/FileUtils.h"
+#include "core/ProgramCache.h"
+#include "core/ShaderLibrary.h"
+#include "core/ShaderManager.h"
+#include "core/ShaderReloader.h"
 
 class ComputeShader {
 public:
-    unsigned int ID = 0;
-    bool valid = false;   // true only after successful compile+link
+    // Changes when a hot reload swaps in a rebuilt program (ShaderReloader).
+    mutable unsigned int ID = 0;
+    // true only after successful compile+link. Settled by ready(), which
+    // every use/dispatch/setter calls first (see ShaderManager).
+    mutable bool valid = false;
 
-    void setUp(const char* source) {
-        valid = false;
+    ComputeShader() = default;
+    ComputeShader(const ComputeShader&) = default;
+    ComputeShader& operator=(const ComputeShader&) = default;
+    // A rebuild still staged must not outlive the shader it belongs to.
+    ~ComputeShader() {
+        if (next_) ShaderReloader::instance().unstage(this);
+    }
 
-        unsigned int cs = glCreateShader(GL_COMPUTE_SHADER);
-        glShaderSource(cs, 1, &source, NULL);
-        glCompileShader(cs);
+    // Submits the compile and link; the result is checked on first use
+    // unless ShaderManager::deferred is off. `label` names the program in
+    // error messages.
+    void setUp(const char* source, const std::string& label = "embedded source") {
+        valid    = false;
+        pending_ = 0;
+        label_   = label;
 
-        int success;
-        char infoLog[1024];
-        glGetShaderiv(cs, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(cs, 1024, NULL, infoLog);
-            std::cout << "ERROR::COMPUTE_SHADER::COMPILATION_FAILED\n" << infoLog << std::endl;
-            glDeleteShader(cs);
+        ProgramCache& cache = ProgramCache::instance();
+        key_ = cache.key({ { GL_COMPUTE_SHADER, source } });
+        ID = cache.load(key_);
+        if (ID) {
+            finishSetUp(" (cached)");
             return;
         }
 
-        ID = glCreateProgram();
-        glAttachShader(ID, cs);
-        glLinkProgram(ID);
+        ID = submit(source, pending_);
+        if (!ShaderManager::instance().deferred) ready();
+    }
 
-        glGetProgramiv(ID, GL_LINK_STATUS, &success);
-        if (!success) {
-            glGetProgramInfoLog(ID, 1024, NULL, infoLog);
-            std::cout << "ERROR::COMPUTE_SHADER::LINKING_FAILED\n" << infoLog << std::endl;
-            glDeleteShader(cs);
-            return;
+    // Checks a submitted program (blocking until the driver is done with
+    // it) and reports a failure once. With hot reload on, also submits a
+    // rebuild after a shader change (ShaderReloader swaps it in). True if
+    // the program is usable.
+    bool ready() const {
+        if (pending_) {
+            unsigned int cs = pending_;
+            pending_ = 0;
+            if (ID && checkBuild(ID, cs, label_)) {   // !ID: deleted before first use
+                ProgramCache::instance().store(key_, ID);
+                finishSetUp("");
+            }
         }
-        glDeleteShader(cs);
-
-        // Cache local work group size
-        glGetProgramiv(ID, GL_COMPUTE_WORK_GROUP_SIZE, localSize);
-        valid = true;
-
-        std::cout << "  -> local_size = ("
-                  << localSize[0] << ", " << localSize[1] << ", " << localSize[2] << ")\n";
+        if (!path_.empty() && ShaderReloader::instance().enabled()) hotReload();
+        return valid;
     }
 
-    void setUpFromFile(const std::string& path) {
+    // `path` from the project root; the source comes from ShaderLibrary
+    // (embedded, or read from disk in dev mode), with `defines` injected.
+    // Programs set up this way are rebuilt by hot reload.
+    void setUpFromFile(const std::string& path, const std::string& defines = "",
+                       const std::string& label = "") {
+        path_       = path;
+        defines_    = defines;
+        label_      = label.empty() ? path : label;
+        generation_ = ShaderReloader::instance().generation();
         std::string src;
         try {
-            src = loadTextFile(path);
+            src = sourceFor(path, defines);
         } catch (const std::exception& e) {
-            std::cout << "ERROR::COMPUTE_SHADER::FILE_NOT_FOUND: " << path
+            std::cout << "ERROR::COMPUTE_SHADER::FILE_NOT_FOUND: " << path << "\n  " << e.what()
                       << "\n  (working directory matters — run from project root)\n";
             return;
         }
-        std::cout << "[ComputeShader] Compiling " << path << std::endl;
-        setUp(src.c_str());
+        std::cout << "[ComputeShader] Compiling " << label_ << std::endl;
+        setUp(src.c_str(), label_);
+    }
+
+    // Insert `defines` right after the #version line (GLSL requires
+    // #version first), or at the top if the source has none.
+    static std::string injectDefines(const std::string& src, const std::string& defines) {
+        size_t at = src.find("#version");
+        if (at == std::string::npos) return defines + src;
+        size_t eol = src.find('\n', at);
+        if (eol == std::string::npos) return src + "\n" + defines;
+        return src.substr(0, eol + 1) + defines + src.substr(eol + 1);
     }
 
     void use() const {
-        if (!valid) return;
+        if (!ready()) return;
         glUseProgram(ID);
     }
 
     // Dispatch with automatic ceil-division to cover totalX * totalY * totalZ work items
     void dispatch(int totalX, int totalY = 1, int totalZ = 1) const {
-        if (!valid) {
+        if (!ready()) {
             std::cout << "WARNING: Skipping dispatch on invalid compute shader (ID="
                       << ID << ")\n";
             return;
@@ -84,30 +116,239 @@ public:
         );
     }
 
-    // Uniform setters (guarded — no-op if shader is invalid)
-    void setInt(const std::string& name, int value) const {
-        if (!valid) return;
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    // Dispatch with group counts read from a GL_DISPATCH_INDIRECT_BUFFER
+    // (uint x, y, z at byteOffset), e.g. written by a previous compute pass.
+    void dispatchIndirect(GLuint argsBuffer, GLintptr byteOffset = 0) const {
+        if (!ready()) {
+            std::cout << "WARNING: Skipping indirect dispatch on invalid compute shader (ID="
+                      << ID << ")\n";
+            return;
+        }
+        glUseProgram(ID);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, argsBuffer);
+        glDispatchComputeIndirect(byteOffset);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+    }
+
+    // Uniform setters (guarded — no-op if shader is invalid). Names are
+    // C strings so literal names never build a std::string.
+    void setInt(const char* name, int value) const {
+        if (!ready()) return;
+        glUniform1i(glGetUniformLocation(ID, name), value);
     }
-    void setFloat(const std::string& name, float value) const {
-        if (!valid) return;
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    void setFloat(const char* name, float value) const {
+        if (!ready()) return;
+        glUniform1f(glGetUniformLocation(ID, name), value);
     }
-    void setVec3(const std::string& name, const glm::vec3& v) const {
-        if (!valid) return;
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(v));
+    void setVec3(const char* name, const glm::vec3& v) const {
+        if (!ready()) return;
+        glUniform3fv(glGetUniformLocation(ID, name), 1, glm::value_ptr(v));
     }
-    void setIVec3(const std::string& name, const glm::ivec3& v) const {
-        if (!valid) return;
-        glUniform3iv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(v));
+    void setIVec3(const char* name, const glm::ivec3& v) const {
+        if (!ready()) return;
+        glUniform3iv(glGetUniformLocation(ID, name), 1, glm::value_ptr(v));
     }
-    void setMat4(const std::string& name, const glm::mat4& m) const {
-        if (!valid) return;
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(m));
+    void setMat4(const char* name, const glm::mat4& m) const {
+        if (!ready()) return;
+        glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(m));
     }
 
 private:
-    GLint localSize[3] = {1, 1, 1};
+    mutable GLint        localSize[3] = {1, 1, 1};
+    mutable unsigned int pending_ = 0;   // compute shader of a submitted, unchecked program
+    mutable uint64_t     key_ = 0;       // ProgramCache key
+    std::string          label_;
+
+    // Hot reload (setUpFromFile programs only)
+    std::string          path_;
+    std::string          defines_;
+    mutable uint32_t     generation_   = 0;   // ShaderReloader generation last looked at
+    mutable unsigned int next_         = 0;   // rebuilt program waiting to be swapped in
+    mutable unsigned int nextShader_   = 0;   // its compute shader; 0 if from the cache
+    mutable uint64_t     nextKey_      = 0;
+
+    static std::string sourceFor(const std::string& path, const std::string& defines) {
+        std::string all = defines;
+#ifdef SMOKE_STATS
+        all = "#define SMOKE_STATS 1\n" + all;
+#endif
+        std::string src = ShaderLibrary::instance().load(path);
+        return all.empty() ? src : injectDefines(src, all);
+    }
+
+    // Compiles and links without waiting; `cs` gets the compute shader,
+    // only flagged for deletion while attached so checkBuild() can still
+    // read its compile log.
+    static unsigned int submit(const char* source, unsigned int& cs) {
+        cs = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(cs, 1, &source, NULL);
+        glCompileShader(cs);
+
+        unsigned int program = glCreateProgram();
+        glAttachShader(program, cs);
+        ProgramCache::instance().prepare(program);
+        glLinkProgram(program);
+        glDeleteShader(cs);
+        ShaderManager::instance().submitted++;
+        return program;
+    }
+
+    // Compile and link status of a submitted program, logged on failure.
+    static bool checkBuild(unsigned int program, unsigned int cs, const std::string& label) {
+        ShaderManager::Wait wait;
+        int success;
+        char infoLog[1024];
+        glGetShaderiv(cs, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            glGetShaderInfoLog(cs, 1024, NULL, infoLog);
+            std::cout << "ERROR::COMPUTE_SHADER::COMPILATION_FAILED (" << label << ")\n"
+                      << infoLog << std::endl;
+            glDetachShader(program, cs);
+            return false;
+        }
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(program, 1024, NULL, infoLog);
+            std::cout << "ERROR::COMPUTE_SHADER::LINKING_FAILED (" << label << ")\n"
+                      << infoLog << std::endl;
+            glDetachShader(program, cs);
+            return false;
+        }
+        glDetachShader(program, cs);
+        return true;
+    }
+
+    // Submits and stages a rebuild after a shader change; ShaderReloader
+    // swaps the whole change set in at a frame start (stagedFinish()).
+    void hotReload() const {
+        ShaderReloader& reloader = ShaderReloader::instance();
+        if (generation_ == reloader.generation()) return;
+        generation_ = reloader.generation();
+        submitReload();
+    }
+
+    void submitReload() const {
+        std::string src;
+        try {
+            src = sourceFor(path_, defines_);
+        } catch (const std::exception& e) {
+            std::cout << "[ShaderReloader] " << e.what() << "\n";
+            return;
+        }
+        ProgramCache& cache = ProgramCache::instance();
+        uint64_t key = cache.key({ { GL_COMPUTE_SHADER, src.c_str() } });
+        if (next_ && key == nextKey_) return;   // already building this one
+        if (next_) glDeleteProgram(next_);      // superseded by a newer edit
+        next_ = 0;
+        if (key == key_) {                      // unchanged, or an edit undone
+            ShaderReloader::instance().unstage(this);
+            return;
+        }
+
+        std::cout << "[ShaderReloader] Rebuilding " << label_ << "\n";
+        nextKey_    = key;
+        nextShader_ = 0;
+        next_       = cache.load(key);
+        if (!next_) next_ = submit(src.c_str(), nextShader_);
+        ShaderReloader::instance().stage({ this, &stagedBuilt, &stagedCheck, &stagedFinish });
+    }
+
+    // ShaderReloader::Staged callbacks; `owner` is the staging shader.
+    static bool stagedBuilt(const void* owner) {
+        const ComputeShader& s = *static_cast<const ComputeShader*>(owner);
+        return ShaderManager::instance().completed(s.next_);
+    }
+
+    static bool stagedCheck(const void* owner) {
+        const ComputeShader& s = *static_cast<const ComputeShader*>(owner);
+        if (!s.nextShader_) return true;   // from the cache
+        unsigned int cs = s.nextShader_;
+        s.nextShader_ = 0;
+        if (!checkBuild(s.next_, cs, s.label_)) return false;
+        ProgramCache::instance().store(s.nextKey_, s.next_);
+        return true;
+    }
+
+    static void stagedFinish(const void* owner, bool swap) {
+        const ComputeShader& s = *static_cast<const ComputeShader*>(owner);
+        unsigned int program = s.next_;
+        s.next_ = 0;
+        if (!swap) {
+            glDeleteProgram(program);
+            return;
+        }
+        if (s.ID) {
+            copyUniforms(s.ID, program);
+            glDeleteProgram(s.ID);
+        }
+        s.ID   = program;
+        s.key_ = s.nextKey_;
+        s.finishSetUp(" (reloaded)");
+    }
+
+    // Carries the plain uniforms (not block members) of `from` over to
+    // `to`, so values set once at set-up survive a swap.
+    static void copyUniforms(unsigned int from, unsigned int to) {
+        GLint count = 0;
+        glGetProgramiv(from, GL_ACTIVE_UNIFORMS, &count);
+        for (GLint u = 0; u < count; u++) {
+            char name[256];
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(from, (GLuint)u, sizeof(name), NULL, &size, &type, name);
+            std::string base = name;
+            if (base.size() > 3 && base.compare(base.size() - 3, 3, "[0]") == 0)
+                base.resize(base.size() - 3);
+            for (GLint i = 0; i < size; i++) {
+                std::string element = size > 1 ? base + "[" + std::to_string(i) + "]" : base;
+                GLint src = glGetUniformLocation(from, element.c_str());
+                GLint dst = glGetUniformLocation(to, element.c_str());
+                if (src >= 0 && dst >= 0) copyUniform(from, src, to, dst, type);
+            }
+        }
+    }
+
+    static void copyUniform(unsigned int from, GLint src, unsigned int to, GLint dst, GLenum type) {
+        GLfloat f[16];
+        GLint   n[4];
+        GLuint  un[4];
+        switch (type) {
+        case GL_FLOAT:      glGetUniformfv(from, src, f); glProgramUniform1fv(to, dst, 1, f); break;
+        case GL_FLOAT_VEC2: glGetUniformfv(from, src, f); glProgramUniform2fv(to, dst, 1, f); break;
+        case GL_FLOAT_VEC3: glGetUniformfv(from, src, f); glProgramUniform3fv(to, dst, 1, f); break;
+        case GL_FLOAT_VEC4: glGetUniformfv(from, src, f); glProgramUniform4fv(to, dst, 1, f); break;
+        case GL_FLOAT_MAT3:
+            glGetUniformfv(from, src, f);
+            glProgramUniformMatrix3fv(to, dst, 1, GL_FALSE, f);
+            break;
+        case GL_FLOAT_MAT4:
+            glGetUniformfv(from, src, f);
+            glProgramUniformMatrix4fv(to, dst, 1, GL_FALSE, f);
+            break;
+        case GL_INT_VEC2:   glGetUniformiv(from, src, n); glProgramUniform2iv(to, dst, 1, n); break;
+        case GL_INT_VEC3:   glGetUniformiv(from, src, n); glProgramUniform3iv(to, dst, 1, n); break;
+        case GL_INT_VEC4:   glGetUniformiv(from, src, n); glProgramUniform4iv(to, dst, 1, n); break;
+        case GL_UNSIGNED_INT:      glGetUniformuiv(from, src, un); glProgramUniform1uiv(to, dst, 1, un); break;
+        case GL_UNSIGNED_INT_VEC2: glGetUniformuiv(from, src, un); glProgramUniform2uiv(to, dst, 1, un); break;
+        case GL_UNSIGNED_INT_VEC3: glGetUniformuiv(from, src, un); glProgramUniform3uiv(to, dst, 1, un); break;
+        case GL_UNSIGNED_INT_VEC4: glGetUniformuiv(from, src, un); glProgramUniform4uiv(to, dst, 1, un); break;
+        default:
+            // int, bool and every sampler/image type: one int
+            glGetUniformiv(from, src, n);
+            glProgramUniform1iv(to, dst, 1, n);
+            break;
+        }
+    }
+
+    void finishSetUp(const char* note) const {
+        // Cache local work group size
+        glGetProgramiv(ID, GL_COMPUTE_WORK_GROUP_SIZE, localSize);
+        valid = true;
+
+        std::cout << "  -> local_size = ("
+                  << localSize[0] << ", " << localSize[1] << ", " << localSize[2] << ") "
+                  << label_ << note << "\n";
+    }
 };
 
 #endif // COMPUTE_SHADER_H
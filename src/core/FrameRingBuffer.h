@@ -0,0 +1,168 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "core/Buffer.h"
+
+// Persistently mapped ring for per-frame CPU -> GPU data.
+//
+// One immutable buffer (glBufferStorage, MAP_WRITE | PERSISTENT | COHERENT)
+// split into SLOTS frame slots. beginFrame() moves to the next slot and waits
+// on that slot's fence, which was placed SLOTS frames ago and has normally
+// long signalled; endFrame() fences the slot. In between, allocate()/write()
+// hand out aligned sub-ranges of the slot that the CPU fills through the
+// mapped pointer, and the GPU reads them by offset: bindRange() for
+// UBO/SSBO bindings, upload() copies into an existing SSBO on the GPU.
+// No glBufferSubData, so no driver-side staging copy or implicit sync.
+//
+// Shared through FrameRingBuffer::instance(); init() once a context exists.
+//
+// Needs glBufferStorage (GL 4.4, see hasBufferStorage()). Without it init()
+// says so and the ring stays off: allocate() returns empty slices, and every
+// caller already has a glBufferSubData path for that (UniformBlock's fallback
+// UBOs, upload(), the light marker's VBO).
+class FrameRingBuffer {
+public:
+    static constexpr int SLOTS = 3;
+
+    struct Slice {
+        void*      ptr    = nullptr;   // mapped, CPU-writable this frame
+        GLintptr   offset = 0;         // byte offset into buffer()
+        GLsizeiptr size   = 0;
+        explicit operator bool() const { return ptr != nullptr; }
+    };
+
+    static FrameRingBuffer& instance() {
+        static FrameRingBuffer ring;
+        return ring;
+    }
+
+    void init(size_t bytesPerSlot = 256 * 1024) {
+        GLint uboAlign = 256, ssboAlign = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,        &uboAlign);
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &ssboAlign);
+        alignment = (size_t)std::max({ uboAlign, ssboAlign, 16 });
+
+        slotBytes = (bytesPerSlot + alignment - 1) / alignment * alignment;
+        if (!hasBufferStorage()) {
+            std::cerr << "[FrameRingBuffer] glBufferStorage unavailable (needs GL 4.4); "
+                         "per-frame data goes through glBufferSubData\n";
+            return;
+        }
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(slotBytes * SLOTS), nullptr, flags);
+        mapped = static_cast<uint8_t*>(
+            glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)(slotBytes * SLOTS), flags));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        if (!mapped) std::cerr << "[FrameRingBuffer] Persistent map failed\n";
+    }
+
+    GLuint buffer() const { return ID; }
+
+    void beginFrame() {
+        slot = (slot + 1) % SLOTS;
+        if (fences[slot]) {
+            // SLOTS frames old; only blocks if the GPU is that far behind.
+            GLenum r = glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            while (r == GL_TIMEOUT_EXPIRED)
+                r = glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            glDeleteSync(fences[slot]);
+            fences[slot] = nullptr;
+        }
+        head = 0;
+    }
+
+    void endFrame() {
+        if (fences[slot]) glDeleteSync(fences[slot]);
+        fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    // Aligned space in this frame's slot; empty Slice if the slot is full.
+    Slice allocate(size_t bytes) {
+        if (!mapped) return Slice{};   // off, or the map failed (reported by init())
+        size_t start = (head + alignment - 1) / alignment * alignment;
+        if (start + bytes > slotBytes) {
+            if (!overflowReported) {
+                std::cerr << "[FrameRingBuffer] Slot overflow (" << start + bytes
+                          << " > " << slotBytes << " bytes); raise bytesPerSlot\n";
+                overflowReported = true;
+            }
+            return Slice{};
+        }
+        head = start + bytes;
+        Slice s;
+        s.offset = (GLintptr)(slot * slotBytes + start);
+        s.ptr    = mapped + s.offset;
+        s.size   = (GLsizeiptr)bytes;
+        return s;
+    }
+
+    Slice write(const void* data, size_t bytes) {
+        Slice s = allocate(bytes);
+        if (s) std::memcpy(s.ptr, data, bytes);
+        return s;
+    }
+
+    template<typename T>
+    Slice write(const T& value) { return write(&value, sizeof(T)); }
+
+    template<typename T>
+    Slice write(const std::vector<T>& values) { return write(values.data(), values.size() * sizeof(T)); }
+
+    // target: GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER.
+    void bindRange(GLenum target, GLuint binding, const Slice& s) const {
+        glBindBufferRange(target, binding, ID, s.offset, s.size);
+    }
+
+    // GPU-side copy of CPU data into dst (e.g. resetting indirect args or
+    // atomic counters). Falls back to glBufferSubData if the slot is full.
+    template<typename T>
+    void upload(const SSBOBuffer& dst, const std::vector<T>& values, GLintptr dstOffset = 0) {
+        Slice s = write(values);
+        if (!s) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, dst.ID);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, dstOffset, values.size() * sizeof(T), values.data());
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            return;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER,  ID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, dst.ID);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, s.offset, dstOffset, s.size);
+        glBindBuffer(GL_COPY_READ_BUFFER,  0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void destroy() {
+        for (GLsync& f : fences) {
+            if (f) glDeleteSync(f);
+            f = nullptr;
+        }
+        if (ID) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            glDeleteBuffers(1, &ID);
+        }
+        ID     = 0;
+        mapped = nullptr;
+    }
+
+private:
+    GLuint   ID        = 0;
+    uint8_t* mapped    = nullptr;
+    size_t   slotBytes = 0;
+    size_t   alignment = 256;
+    size_t   head      = 0;
+    int      slot      = 0;
+    GLsync   fences[SLOTS] = {};
+    bool     overflowReported = false;
+
+    FrameRingBuffer() = default;
+};
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Frame capture to a Chrome trace-event JSON (open in ui.perfetto.dev or
+// chrome://tracing).
+//
+// start(N) records the next N frames: CPU scopes on one track, GPU scopes
+// on another, both on a shared microsecond timeline. CPU scopes use
+// steady_clock; GPU scopes bracket the pass with GL_TIMESTAMP queries. At
+// every frame start the GPU clock is sampled (glGetInteger64v(GL_TIMESTAMP))
+// next to the CPU clock, and that frame's GPU timestamps are placed relative
+// to the pair, so drift between the clocks never accumulates past a frame.
+//
+// Nothing is read back while capturing; the queries are resolved once, with
+// a glFinish, when the last frame ends, and the file is written then.
+// Outside a capture every call is a cheap early-out.
+class FrameTrace {
+public:
+    int         captureFrames = 8;
+    std::string path          = "frame_trace.json";
+
+    static FrameTrace& instance() {
+        static FrameTrace trace;
+        return trace;
+    }
+
+    void start(int frames) {
+        if (active || frames <= 0) return;
+        captureFrames = frames;
+        framesDone    = 0;
+        origin        = Clock::now();
+        cpuEvents.clear();
+        gpuEvents.clear();
+        syncs.clear();
+        cpuOpen.clear();
+        gpuOpen.clear();
+        queriesUsed = 0;
+        active      = true;
+        frameOpen   = false;
+        std::cout << "[FrameTrace] Capturing " << frames << " frames\n";
+    }
+
+    bool capturing() const { return active; }
+    int  framesCaptured() const { return framesDone; }
+
+    // Call first thing each frame; closes the previous frame and finishes
+    // the capture once enough frames are in.
+    void beginFrame() {
+        if (!active) return;
+        if (frameOpen) {
+            closeFrame();
+            if (++framesDone >= captureFrames) { finish(); return; }
+        }
+
+        Sync s;
+        glGetInteger64v(GL_TIMESTAMP, &s.gpuNs);
+        s.cpuUs = nowUs();
+        syncs.push_back(s);
+
+        frameName = "Frame " + std::to_string(framesDone);
+        cpuOpen.push_back({ frameName.c_str(), s.cpuUs, true });
+        frameOpen = true;
+    }
+
+    void cpuBegin(const char* name) {
+        if (!active || !frameOpen) return;
+        cpuOpen.push_back({ name, nowUs(), false });
+    }
+
+    void cpuEnd() {
+        if (!active || cpuOpen.empty() || cpuOpen.back().isFrame) return;
+        closeCpu();
+    }
+
+    void gpuBegin(const char* name) {
+        if (!active || !frameOpen) return;
+        GpuOpen g;
+        g.name  = name;
+        g.begin = nextQuery();
+        glQueryCounter(queries[g.begin], GL_TIMESTAMP);
+        gpuOpen.push_back(g);
+    }
+
+    void gpuEnd() {
+        if (!active || gpuOpen.empty()) return;
+        GpuOpen g = gpuOpen.back();
+        gpuOpen.pop_back();
+        GpuEvent e;
+        e.name  = g.name;
+        e.begin = g.begin;
+        e.end   = nextQuery();
+        e.sync  = (int)syncs.size() - 1;
+        glQueryCounter(queries[e.end], GL_TIMESTAMP);
+        gpuEvents.push_back(e);
+    }
+
+    void destroy() {
+        if (!queries.empty()) glDeleteQueries((GLsizei)queries.size(), queries.data());
+        queries.clear();
+        queriesUsed = 0;
+        active = false;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct CpuOpen {
+        const char* name;
+        double      startUs;
+        bool        isFrame;
+    };
+    struct CpuEvent {
+        std::string name;
+        double      startUs;
+        double      durUs;
+    };
+    struct GpuOpen {
+        const char* name  = nullptr;
+        int         begin = 0;
+    };
+    struct GpuEvent {
+        const char* name  = nullptr;
+        int         begin = 0;   // query indices
+        int         end   = 0;
+        int         sync  = 0;
+    };
+    struct Sync {
+        GLint64 gpuNs = 0;
+        double  cpuUs = 0.0;
+    };
+
+    bool              active      = false;
+    bool              frameOpen   = false;
+    int               framesDone  = 0;
+    int               queriesUsed = 0;
+    Clock::time_point origin;
+    std::string       frameName;
+
+    std::vector<GLuint>   queries;   // grows, kept across captures
+    std::vector<CpuOpen>  cpuOpen;
+    std::vector<GpuOpen>  gpuOpen;
+    std::vector<CpuEvent> cpuEvents;
+    std::vector<GpuEvent> gpuEvents;
+    std::vector<Sync>     syncs;
+
+    FrameTrace() = default;
+
+    double nowUs() const {
+        return std::chrono::duration<double, std::micro>(Clock::now() - origin).count();
+    }
+
+    int nextQuery() {
+        if (queriesUsed == (int)queries.size()) {
+            GLuint q = 0;
+            glGenQueries(1, &q);
+            queries.push_back(q);
+        }
+        return queriesUsed++;
+    }
+
+    void closeCpu() {
+        CpuOpen o = cpuOpen.back();
+        cpuOpen.pop_back();
+        cpuEvents.push_back({ o.name, o.startUs, nowUs() - o.startUs });
+    }
+
+    // Closes every scope still open (unbalanced begin) and the frame itself.
+    void closeFrame() {
+        while (!cpuOpen.empty()) closeCpu();
+        while (!gpuOpen.empty()) gpuEnd();
+        frameOpen = false;
+    }
+
+    void finish() {
+        active = false;
+        glFinish();
+
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "[FrameTrace] Cannot write " << path << "\n";
+            return;
+        }
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+        out.setf(std::ios::fixed);
+        out.precision(3);
+        for (const CpuEvent& e : cpuEvents)
+            writeEvent(out, e.name.c_str(), 1, e.startUs, e.durUs);
+
+        for (const GpuEvent& e : gpuEvents) {
+            GLuint64 t0 = 0, t1 = 0;
+            glGetQueryObjectui64v(queries[e.begin], GL_QUERY_RESULT, &t0);
+            glGetQueryObjectui64v(queries[e.end],   GL_QUERY_RESULT, &t1);
+            const Sync& s = syncs[e.sync];
+            double startUs = s.cpuUs + ((double)(GLint64)t0 - (double)s.gpuNs) * 1e-3;
+            writeEvent(out, e.name, 2, startUs, (double)(t1 - t0) * 1e-3);
+        }
+        out << "\n]}\n";
+
+        std::cout << "[FrameTrace] Wrote " << framesDone << " frames ("
+                  << cpuEvents.size() << " CPU, " << gpuEvents.size()
+                  << " GPU events) to " << path << "\n";
+
+        cpuEvents.clear();
+        gpuEvents.clear();
+        syncs.clear();
+        queriesUsed = 0;
+    }
+
+    static void writeEvent(std::ofstream& out, const char* name, int tid, double ts, double dur) {
+        out << ",\n{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+            << ",\"ts\":" << ts << ",\"dur\":" << dur << "}";
+    }
+};
+
+// RAII helper: CpuTraceScope scope("ImGui");
+struct CpuTraceScope {
+    explicit CpuTraceScope(const char* name) { FrameTrace::instance().cpuBegin(name); }
+    ~CpuTraceScope() { FrameTrace::instance().cpuEnd(); }
+    CpuTraceScope(const CpuTraceScope&) = delete;
+    CpuTraceScope& operator=(const CpuTraceScope&) = delete;
+};
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/FrameTrace.h"
+
+// Per-pass GPU timings from GL_TIME_ELAPSED queries.
+//
+// Wrap each pass in begin("Name") / end(), or a GpuScope. Each frame's
+// queries go into one of FRAMES_IN_FLIGHT query sets. beginFrame() polls the
+// pending sets oldest first and reads back those the driver reports
+// available, so reading never stalls; a set that is not ready stays pending
+// and is polled again next frame. Only when every set is still pending is
+// the new frame left untimed, counted in skippedFrames().
+//
+// GL_TIME_ELAPSED queries cannot nest; a begin() inside an open scope is
+// ignored, so only leaf passes should be instrumented.
+//
+// Shared by every pass through GpuProfiler::instance(). While `recording`,
+// each resolved frame is kept for exportCSV() (long format: frame,pass,ms),
+// up to MAX_ROWS rows; recording then stops until the rows are cleared.
+// Scopes are also forwarded to FrameTrace, which times them on its own
+// CPU and GPU tracks while a capture is running.
+class GpuProfiler {
+public:
+    static constexpr int    FRAMES_IN_FLIGHT = 4;         // query sets, pending or recording
+    static constexpr int    HISTORY          = 120;       // frames in the rolling average
+    static constexpr size_t MAX_ROWS         = 1 << 20;   // recorded rows, 16 bytes each
+
+    struct PassStats {
+        std::string name;
+        float    lastMs = 0.0f;
+        float    avgMs  = 0.0f;
+        float    history[HISTORY] = {};
+        int      historyCount = 0;   // samples in avgMs, up to HISTORY
+        int      historyHead  = 0;
+        uint64_t lastFrame    = 0;   // frame the last sample came from
+    };
+
+    bool enabled   = true;
+    bool recording = false;
+
+    static GpuProfiler& instance() {
+        static GpuProfiler profiler;
+        return profiler;
+    }
+
+    // Call once per frame before the first pass.
+    void beginFrame() {
+        if (!enabled) return;
+        frameIndex++;
+        openScopes = 0;
+
+        // Last frame's set joins the pending ones (right after them).
+        if (current >= 0 && sets[current].used > 0) pendingCount++;
+
+        // Queries complete in submission order: stop at the first set
+        // that is not ready.
+        while (pendingCount > 0 && ready(sets[oldest])) {
+            collect(sets[oldest]);
+            oldest = (oldest + 1) % FRAMES_IN_FLIGHT;
+            pendingCount--;
+        }
+
+        if (pendingCount == FRAMES_IN_FLIGHT) {
+            current = -1;   // all sets still in flight; this frame goes untimed
+            skipped++;
+            return;
+        }
+        current = (oldest + pendingCount) % FRAMES_IN_FLIGHT;
+        sets[current].used  = 0;
+        sets[current].frame = frameIndex;
+    }
+
+    void begin(const char* name) {
+        FrameTrace& trace = FrameTrace::instance();
+        trace.cpuBegin(name);
+        trace.gpuBegin(name);
+        if (!enabled || current < 0 || openScopes++ > 0) return;
+        FrameSet& set = sets[current];
+        if (set.used == (int)set.entries.size()) {
+            Entry e;
+            glGenQueries(1, &e.query);
+            set.entries.push_back(e);
+        }
+        Entry& e = set.entries[set.used++];
+        e.name = name;
+        glBeginQuery(GL_TIME_ELAPSED, e.query);
+    }
+
+    void end() {
+        FrameTrace& trace = FrameTrace::instance();
+        trace.gpuEnd();
+        trace.cpuEnd();
+        if (!enabled || openScopes == 0) return;
+        if (--openScopes == 0) glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    // Time of `name` from the most recently resolved frame; false if that
+    // frame did not contain the pass (or nothing has resolved yet).
+    // Linear scan by name: a handful of passes, and no std::string built.
+    bool latestMs(const char* name, float& ms) const {
+        for (const PassStats& s : passes) {
+            if (std::strcmp(s.name.c_str(), name) != 0) continue;
+            if (s.lastFrame != resolvedFrame) return false;
+            ms = s.lastMs;
+            return true;
+        }
+        return false;
+    }
+
+    // Passes in first-seen order.
+    const std::vector<PassStats>& stats() const { return passes; }
+    float    lastFrameTotalMs() const { return frameTotalMs; }
+    uint64_t skippedFrames()    const { return skipped; }
+    // Frame number of the newest resolved set; changes when new data arrives.
+    uint64_t resolvedFrameIndex() const { return resolvedFrame; }
+
+    void clearRecording() { rows.clear(); }
+    size_t recordedRows() const { return rows.size(); }
+
+    bool exportCSV(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "[GpuProfiler] Cannot write " << path << "\n";
+            return false;
+        }
+        out << "frame,pass,ms\n";
+        for (const Row& r : rows)
+            out << r.frame << "," << passes[r.pass].name << "," << r.ms << "\n";
+        std::cout << "[GpuProfiler] Wrote " << rows.size() << " rows to " << path << "\n";
+        return true;
+    }
+
+    void destroy() {
+        for (FrameSet& set : sets) {
+            for (Entry& e : set.entries) glDeleteQueries(1, &e.query);
+            set.entries.clear();
+            set.used = 0;
+        }
+        current      = -1;
+        oldest       = 0;
+        pendingCount = 0;
+    }
+
+private:
+    struct Entry {
+        const char* name  = nullptr;
+        GLuint      query = 0;
+    };
+    struct FrameSet {
+        std::vector<Entry> entries;
+        int      used  = 0;
+        uint64_t frame = 0;
+    };
+    struct Row {
+        uint64_t frame;
+        int      pass;
+        float    ms;
+    };
+
+    FrameSet sets[FRAMES_IN_FLIGHT];
+    uint64_t frameIndex    = 0;
+    uint64_t resolvedFrame = 0;
+    uint64_t skipped       = 0;
+    int      current       = -1;   // set recording this frame; -1 = untimed
+    int      oldest        = 0;    // oldest pending set
+    int      pendingCount  = 0;    // submitted, not yet read back
+    int      openScopes    = 0;
+    float    frameTotalMs  = 0.0f;
+
+    std::vector<PassStats>               passes;
+    std::unordered_map<std::string, int> lookup;
+    std::unordered_map<const char*, int> literalLookup;   // fast path, no string build
+    std::vector<Row>                     rows;
+
+    GpuProfiler() = default;
+
+    // Queries complete in order; if the last one is ready, all are.
+    static bool ready(const FrameSet& set) {
+        GLint available = 0;
+        glGetQueryObjectiv(set.entries[set.used - 1].query, GL_QUERY_RESULT_AVAILABLE, &available);
+        return available != 0;
+    }
+
+    void collect(const FrameSet& set) {
+        frameTotalMs = 0.0f;
+        for (int i = 0; i < set.used; i++) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(set.entries[i].query, GL_QUERY_RESULT, &ns);
+            float ms = (float)ns * 1e-6f;
+            frameTotalMs += ms;
+
+            int idx = passIndex(set.entries[i].name);
+            PassStats& s = passes[idx];
+            // A pass may run more than once per frame; sum its scopes.
+            if (s.lastFrame == set.frame) {
+                s.lastMs += ms;
+                s.history[(s.historyHead + HISTORY - 1) % HISTORY] = s.lastMs;
+            } else {
+                s.lastMs = ms;
+                s.lastFrame = set.frame;
+                s.history[s.historyHead] = ms;
+                s.historyHead = (s.historyHead + 1) % HISTORY;
+                if (s.historyCount < HISTORY) s.historyCount++;
+            }
+            float sum = 0.0f;
+            for (int h = 0; h < s.historyCount; h++) sum += s.history[h];
+            s.avgMs = sum / (float)s.historyCount;
+
+            if (recording) {
+                if (rows.size() < MAX_ROWS) {
+                    rows.push_back({ set.frame, idx, ms });
+                } else {
+                    std::cerr << "[GpuProfiler] " << MAX_ROWS
+                              << " rows recorded; recording stopped, export and clear to continue\n";
+                    recording = false;
+                }
+            }
+        }
+        resolvedFrame = set.frame;
+    }
+
+    int passIndex(const char* name) {
+        auto lit = literalLookup.find(name);
+        if (lit != literalLookup.end()) return lit->second;
+
+        // Same name from another translation unit may be a different pointer.
+        int idx;
+        auto it = lookup.find(name);
+        if (it != lookup.end()) {
+            idx = it->second;
+        } else {
+            PassStats s;
+            s.name = name;
+            passes.push_back(s);
+            idx = (int)passes.size() - 1;
+            lookup.emplace(name, idx);
+        }
+        literalLookup.emplace(name, idx);
+        return idx;
+    }
+};
+
+// RAII helper: GpuScope scope("Raymarch");
+struct GpuScope {
+    explicit GpuScope(const char* name) { GpuProfiler::instance().begin(name); }
+    ~GpuScope() { GpuProfiler::instance().end(); }
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+};
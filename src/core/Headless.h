@@ -0,0 +1,187 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Offscreen runs without a visible window or ImGui (render farm nodes, CI
+// machines with only Mesa's software GL):
+//
+//   GraphicsProject --headless [--frames N] [--size WxH] [--dt SECONDS]
+//                              [--dump DIR] [--dump-every K]
+//
+// createWindow() first asks GLFW (3.4+) for its null platform with an EGL
+// context, i.e. surfaceless EGL that needs no display server; if the driver
+// cannot do that it falls back to a hidden window on the regular platform.
+// main then runs the simulation and every render pass into an offscreen
+// framebuffer at a fixed timestep for `frames` frames, prints timings, and
+// optionally writes every K-th frame to DIR as a PPM.
+//
+// parseArgs() also takes --record FILE / --replay FILE (InputTimeline.h)
+// --shader-cache DIR / --no-shader-cache (ProgramCache.h), --serial-shaders
+// (ShaderManager.h), --shader-dev (ShaderLibrary.h), --hot-reload
+// (ShaderReloader.h) and --autotune (SmokeSolver and Raymarcher::autotune),
+// which work with or without --headless.
+namespace Headless {
+
+struct Options {
+    bool        enabled   = false;
+    int         frames    = 300;
+    int         width     = 1280;
+    int         height    = 720;
+    float       dt        = 1.0f / 60.0f;   // fixed step, independent of wall time
+    std::string dumpDir;                    // empty = no frame dumps
+    int         dumpEvery = 60;
+    std::string recordPath;                 // --record: write an input timeline
+    std::string replayPath;                 // --replay: drive the run from one
+    std::string shaderCache = "shader_cache";   // program binaries; empty = off
+    bool        serialShaders = false;          // check each program right after linking
+    bool        autotune      = false;          // tune workgroup sizes on the first frame
+    bool        shaderDev     = false;          // read shaders/ instead of the embedded copies
+    bool        hotReload     = false;          // watch shaders/ and rebuild edited kernels
+};
+
+inline void printUsage() {
+    std::cout << "Usage: GraphicsProject [--headless [--frames N] [--size WxH] [--dt SECONDS]\n"
+                 "                        [--dump DIR] [--dump-every K]]\n"
+                 "                        [--record FILE | --replay FILE]\n"
+                 "                        [--shader-cache DIR | --no-shader-cache]\n"
+                 "                        [--serial-shaders] [--shader-dev] [--hot-reload]\n"
+                 "                        [--autotune]\n";
+}
+
+// False on an unknown or malformed argument (usage already printed).
+inline bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool ok = true;
+
+        if (!std::strcmp(arg, "--headless")) {
+            opt.enabled = true;
+            continue;
+        }
+        if (!std::strcmp(arg, "--no-shader-cache")) {
+            opt.shaderCache.clear();
+            continue;
+        }
+        if (!std::strcmp(arg, "--serial-shaders")) {
+            opt.serialShaders = true;
+            continue;
+        }
+        if (!std::strcmp(arg, "--shader-dev")) {
+            opt.shaderDev = true;
+            continue;
+        }
+        if (!std::strcmp(arg, "--hot-reload")) {
+            opt.hotReload = true;
+            continue;
+        }
+        if (!std::strcmp(arg, "--autotune")) {
+            opt.autotune = true;
+            continue;
+        }
+        if (!val) ok = false;
+        else if (!std::strcmp(arg, "--frames"))     opt.frames    = std::atoi(val);
+        else if (!std::strcmp(arg, "--dt"))         opt.dt        = (float)std::atof(val);
+        else if (!std::strcmp(arg, "--dump"))       opt.dumpDir   = val;
+        else if (!std::strcmp(arg, "--dump-every")) opt.dumpEvery = std::atoi(val);
+        else if (!std::strcmp(arg, "--record"))     opt.recordPath = val;
+        else if (!std::strcmp(arg, "--replay"))     opt.replayPath = val;
+        else if (!std::strcmp(arg, "--shader-cache")) opt.shaderCache = val;
+        else if (!std::strcmp(arg, "--size"))
+            ok = std::sscanf(val, "%dx%d", &opt.width, &opt.height) == 2;
+        else ok = false;
+
+        if (!ok || opt.frames <= 0 || opt.width <= 0 || opt.height <= 0 ||
+            opt.dt <= 0.0f || opt.dumpEvery <= 0 ||
+            (!opt.recordPath.empty() && !opt.replayPath.empty())) {
+            std::cerr << "Bad argument: " << arg << (val ? std::string(" ") + val : "") << "\n";
+            printUsage();
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+// Initialises GLFW and creates the (invisible) context window.
+// `contextHints` sets the GL version/profile hints; it is called after
+// every glfwInit since a re-init resets them. nullptr on failure, with
+// GLFW terminated.
+inline GLFWwindow* createWindow(int width, int height, const char* title,
+                                void (*contextHints)()) {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    if (glfwInit()) {
+        contextHints();
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        if (GLFWwindow* window = glfwCreateWindow(width, height, title, NULL, NULL)) {
+            std::cout << "[Headless] Surfaceless EGL context\n";
+            return window;
+        }
+        glfwTerminate();
+    }
+    glfwInitHint(GLFW_PLATFORM, GLFW_ANY_PLATFORM);
+#endif
+    if (!glfwInit()) return nullptr;
+    contextHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(width, height, title, NULL, NULL);
+    if (!window) {
+        glfwTerminate();
+        return nullptr;
+    }
+    std::cout << "[Headless] Hidden-window context\n";
+    return window;
+}
+
+// Read the RGBA8 colour attachment of `fbo` and write it as a binary PPM
+// (top row first).
+inline bool dumpPPM(GLuint fbo, int width, int height, const std::string& path) {
+    std::vector<unsigned char> rgba((size_t)width * height * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "[Headless] Cannot write " << path << "\n";
+        return false;
+    }
+    out << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<unsigned char> row((size_t)width * 3);
+    for (int y = height - 1; y >= 0; y--) {
+        const unsigned char* src = &rgba[(size_t)y * width * 4];
+        for (int x = 0; x < width; x++) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        out.write(reinterpret_cast<const char*>(row.data()), (std::streamsize)row.size());
+    }
+    return true;
+}
+
+inline std::string framePath(const std::string& dir, int frame) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05d.ppm", frame);
+    return (std::filesystem::path(dir) / name).string();
+}
+
+inline bool ensureDir(const std::string& dir) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) std::cerr << "[Headless] Cannot create " << dir << ": " << ec.message() << "\n";
+    return !ec;
+}
+
+} // namespace Headless
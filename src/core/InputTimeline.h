@@ -0,0 +1,322 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "camera/OrbitCamera.h"
+#include "Rendering/LightSource.h"
+
+// Deterministic input record / replay for repeatable perf runs.
+//
+//   GraphicsProject --record run.smkr [--dt SECONDS]
+//   GraphicsProject --replay run.smkr [--headless ...]
+//
+// Both modes step the simulation at a fixed dt, so frame N of a replay sees
+// exactly the inputs frame N of the recording saw, whatever the frame rate.
+//
+// Two kinds of events, each stamped with the frame it applies to:
+//   - actions (Seed, Vacuum, Reset, Arena) are recorded where they happen
+//     and handed back to main on replay, which performs them again;
+//   - state (Camera, Light, Param) is captured by diffing once per frame at
+//     the sync point, so every slider, key toggle and camera drag is covered
+//     without touching the widgets. The first capture writes everything, so
+//     a replay starts from the recorded settings, not the build's defaults.
+//
+// Parameters are registered by name (addParam) and matched by name on
+// replay; ones the replaying build does not know are reported and skipped.
+//
+// File: a Header, then Header::eventCount fixed-size Events (little-endian,
+// written as-is).
+class InputTimeline {
+public:
+    enum class Mode { Off, Record, Replay };
+
+    enum EventType : uint32_t {
+        Seed = 0,   // v[0..2] world pos
+        Vacuum,     // v[0..2] world pos
+        Reset,
+        Arena,      // v[0] voxel size, v[1..3] grid size
+        Camera,     // v[0] yaw, v[1] pitch, v[2] dist, v[3] fovy, v[4..6] target
+        Light,      // v[0..2] position, v[3..5] color, v[6] intensity, v[7] ambient
+        Param,      // name, v[0] value (ints and bools stored exactly)
+    };
+
+    struct Event {
+        uint32_t frame = 0;
+        uint32_t type  = 0;
+        float    v[8]  = {};
+        char     name[32] = {};
+    };
+    static_assert(sizeof(Event) == 72, "InputTimeline::Event is written as-is");
+
+    struct Header {
+        uint32_t magic      = MAGIC;
+        uint32_t version    = VERSION;
+        float    dt         = 1.0f / 60.0f;
+        uint32_t frames     = 0;
+        uint32_t width      = 0;
+        uint32_t height     = 0;
+        uint32_t eventCount = 0;
+        uint32_t pad        = 0;
+    };
+
+    Mode mode() const { return mode_; }
+    bool recording() const { return mode_ == Mode::Record; }
+    bool replaying() const { return mode_ == Mode::Replay; }
+
+    float    dt()     const { return header_.dt; }
+    uint32_t frames() const { return header_.frames; }
+    uint32_t replayWidth()  const { return header_.width; }
+    uint32_t replayHeight() const { return header_.height; }
+    // Frame the next action applies to (see sync()).
+    uint32_t stamp()  const { return stamp_; }
+
+    void attach(OrbitCamera* camera, LightSource* light) {
+        camera_ = camera;
+        light_  = light;
+    }
+
+    // Registered once at startup, before the first sync().
+    void addParam(const char* name, float* v) {
+        addParam(name, v, [](void* p) { return *(float*)p; },
+                 [](void* p, float x) { *(float*)p = x; });
+    }
+    void addParam(const char* name, int* v) {
+        addParam(name, v, [](void* p) { return (float)*(int*)p; },
+                 [](void* p, float x) { *(int*)p = (int)x; });
+    }
+    void addParam(const char* name, bool* v) {
+        addParam(name, v, [](void* p) { return *(bool*)p ? 1.0f : 0.0f; },
+                 [](void* p, float x) { *(bool*)p = x != 0.0f; });
+    }
+    // For values behind a getter/setter pair.
+    void addParam(const char* name, void* obj, float (*get)(void*), void (*set)(void*, float)) {
+        ParamSlot s;
+        // A cut name could match another parameter's on replay.
+        if (std::strlen(name) >= sizeof(s.name)) {
+            std::cerr << "[InputTimeline] Parameter name " << name << " is longer than "
+                      << sizeof(s.name) - 1 << " characters; not recorded\n";
+            return;
+        }
+        std::snprintf(s.name, sizeof(s.name), "%s", name);
+        s.obj = obj;
+        s.get = get;
+        s.set = set;
+        params_.push_back(s);
+    }
+
+    void startRecording(const std::string& path, float dt, uint32_t width, uint32_t height) {
+        mode_   = Mode::Record;
+        path_   = path;
+        header_ = Header{};
+        header_.dt     = dt;
+        header_.width  = width;
+        header_.height = height;
+        events_.clear();
+        events_.reserve(1 << 16);
+        for (ParamSlot& s : params_) s.last = NAN;   // first capture writes all
+        haveCamera_ = haveLight_ = false;
+        stamp_ = 0;
+        std::cout << "[InputTimeline] Recording to " << path << " at dt " << dt << " s\n";
+    }
+
+    bool loadReplay(const std::string& path) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) {
+            std::cerr << "[InputTimeline] Cannot read " << path << "\n";
+            return false;
+        }
+        Header h;
+        bool ok = std::fread(&h, sizeof(h), 1, f) == 1 && h.magic == MAGIC && h.version == VERSION;
+        if (ok) {
+            events_.resize(h.eventCount);
+            ok = h.eventCount == 0 ||
+                 std::fread(events_.data(), sizeof(Event), h.eventCount, f) == h.eventCount;
+        }
+        std::fclose(f);
+        if (!ok) {
+            std::cerr << "[InputTimeline] " << path << " is not a version " << VERSION
+                      << " timeline\n";
+            events_.clear();
+            return false;
+        }
+        mode_   = Mode::Replay;
+        path_   = path;
+        header_ = h;
+        cursor_ = 0;
+        stamp_  = 0;
+        std::cout << "[InputTimeline] Replaying " << path << ": " << h.frames << " frames, "
+                  << h.eventCount << " events, dt " << h.dt << " s, recorded at "
+                  << h.width << "x" << h.height << "\n";
+        return true;
+    }
+
+    // Record an action; it applies at stamp(), i.e. before the simulation of
+    // the frame whose sync point comes next.
+    void record(EventType type, const float* v = nullptr, int count = 0) {
+        if (mode_ != Mode::Record) return;
+        Event e;
+        e.frame = stamp_;
+        e.type  = type;
+        for (int i = 0; i < count && i < 8; i++) e.v[i] = v[i];
+        events_.push_back(e);
+    }
+
+    // The per-frame sync point, after input polling and before the
+    // simulation. Record: captures changed state for `frame`. Replay:
+    // applies this frame's state events and returns its actions one by one
+    // through `action`; call until it returns false. Either way, actions
+    // recorded after this call apply to frame + 1.
+    bool sync(uint32_t frame, Event& action) {
+        if (mode_ == Mode::Record) {
+            capture(frame);
+            stamp_ = frame + 1;
+            return false;
+        }
+        if (mode_ != Mode::Replay) return false;
+        stamp_ = frame + 1;
+        while (cursor_ < events_.size() && events_[cursor_].frame <= frame) {
+            const Event& e = events_[cursor_++];
+            if (e.frame < frame) continue;   // only if frames were skipped
+            switch (e.type) {
+            case Camera: applyCamera(e); break;
+            case Light:  applyLight(e);  break;
+            case Param:  applyParam(e);  break;
+            default:
+                action = e;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Replay: true once every recorded frame has run.
+    bool finished(uint32_t frame) const {
+        return mode_ == Mode::Replay && frame >= header_.frames;
+    }
+
+    // Record: write the file. `frames` is how many frames ran.
+    bool save(uint32_t frames) {
+        if (mode_ != Mode::Record) return true;
+        header_.frames     = frames;
+        header_.eventCount = (uint32_t)events_.size();
+        FILE* f = std::fopen(path_.c_str(), "wb");
+        if (!f) {
+            std::cerr << "[InputTimeline] Cannot write " << path_ << "\n";
+            return false;
+        }
+        bool ok = std::fwrite(&header_, sizeof(header_), 1, f) == 1 &&
+                  (events_.empty() ||
+                   std::fwrite(events_.data(), sizeof(Event), events_.size(), f) == events_.size());
+        std::fclose(f);
+        std::cout << "[InputTimeline] Wrote " << events_.size() << " events over " << frames
+                  << " frames to " << path_ << "\n";
+        return ok;
+    }
+
+private:
+    static constexpr uint32_t MAGIC   = 0x524B4D53;   // "SMKR"
+    static constexpr uint32_t VERSION = 1;
+
+    struct ParamSlot {
+        char  name[32] = {};
+        void* obj = nullptr;
+        float (*get)(void*) = nullptr;
+        void  (*set)(void*, float) = nullptr;
+        float last = NAN;
+    };
+
+    Mode               mode_ = Mode::Off;
+    std::string        path_;
+    Header             header_;
+    std::vector<Event> events_;
+    std::vector<ParamSlot> params_;
+    size_t             cursor_ = 0;
+    uint32_t           stamp_  = 0;
+    OrbitCamera*       camera_ = nullptr;
+    LightSource*       light_  = nullptr;
+    Event              lastCamera_, lastLight_;
+    bool               haveCamera_ = false, haveLight_ = false;
+
+    static bool sameValues(const Event& a, const Event& b) {
+        return std::memcmp(a.v, b.v, sizeof(a.v)) == 0;
+    }
+
+    void capture(uint32_t frame) {
+        if (camera_) {
+            Event e;
+            e.frame = frame;
+            e.type  = Camera;
+            e.v[0] = camera_->yaw;
+            e.v[1] = camera_->pitch;
+            e.v[2] = camera_->dist;
+            e.v[3] = camera_->fovy;
+            e.v[4] = camera_->target.x;
+            e.v[5] = camera_->target.y;
+            e.v[6] = camera_->target.z;
+            if (!haveCamera_ || !sameValues(e, lastCamera_)) events_.push_back(e);
+            lastCamera_ = e;
+            haveCamera_ = true;
+        }
+        if (light_) {
+            Event e;
+            e.frame = frame;
+            e.type  = Light;
+            e.v[0] = light_->position.x;
+            e.v[1] = light_->position.y;
+            e.v[2] = light_->position.z;
+            e.v[3] = light_->color.r;
+            e.v[4] = light_->color.g;
+            e.v[5] = light_->color.b;
+            e.v[6] = light_->intensity;
+            e.v[7] = light_->ambientStrength;
+            if (!haveLight_ || !sameValues(e, lastLight_)) events_.push_back(e);
+            lastLight_ = e;
+            haveLight_ = true;
+        }
+        for (ParamSlot& s : params_) {
+            float value = s.get(s.obj);
+            if (value == s.last) continue;   // NaN `last` never compares equal
+            s.last = value;
+            Event e;
+            e.frame = frame;
+            e.type  = Param;
+            e.v[0]  = value;
+            std::memcpy(e.name, s.name, sizeof(e.name));
+            events_.push_back(e);
+        }
+    }
+
+    void applyCamera(const Event& e) {
+        if (!camera_) return;
+        camera_->yaw    = e.v[0];
+        camera_->pitch  = e.v[1];
+        camera_->dist   = e.v[2];
+        camera_->fovy   = e.v[3];
+        camera_->target = glm::vec3(e.v[4], e.v[5], e.v[6]);
+    }
+
+    void applyLight(const Event& e) {
+        if (!light_) return;
+        light_->position        = glm::vec3(e.v[0], e.v[1], e.v[2]);
+        light_->color           = glm::vec3(e.v[3], e.v[4], e.v[5]);
+        light_->intensity       = e.v[6];
+        light_->ambientStrength = e.v[7];
+        light_->syncAngles();
+    }
+
+    void applyParam(const Event& e) {
+        for (ParamSlot& s : params_) {
+            if (std::strncmp(s.name, e.name, sizeof(s.name)) != 0) continue;
+            s.set(s.obj, e.v[0]);
+            return;
+        }
+        std::cerr << "[InputTimeline] Unknown parameter '" << e.name << "' in " << path_ << "\n";
+    }
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// On-disk cache of linked program binaries (GL 4.1 glGetProgramBinary /
+// glProgramBinary), so a warm start links every program without compiling
+// any GLSL.
+//
+// ComputeShader::setUp and shader::setUpShader look a program up by key()
+// before compiling: the key is a 64-bit FNV-1a hash of every stage's final
+// source (after ComputeShader::injectDefines) plus the GL vendor, renderer
+// and version strings, so a driver update or a different GPU simply misses.
+// A binary the driver rejects anyway (GL_LINK_STATUS false after
+// glProgramBinary) is deleted and the program is compiled from source.
+//
+// One file per program, <dir>/<key as 16 hex digits>.bin: a FileHeader and
+// the binary blob. Files are written to a temporary name and renamed, so a
+// second instance never reads a half-written one.
+//
+// Until init() is called (or when the driver offers no binary formats)
+// load() always misses and store() does nothing.
+class ProgramCache {
+public:
+    struct Stage {
+        GLenum      type;
+        const char* source;
+    };
+
+    int hits     = 0;   // programs loaded from disk
+    int compiled = 0;   // programs compiled from source and stored (misses)
+
+    static ProgramCache& instance() {
+        static ProgramCache cache;
+        return cache;
+    }
+
+    bool enabled() const { return enabled_; }
+
+    void init(const std::string& dir) {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if (formats == 0) {
+            std::cout << "[ProgramCache] Driver offers no program binary formats; cache off\n";
+            return;
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        if (ec) {
+            std::cerr << "[ProgramCache] Cannot create " << dir << ": " << ec.message() << "\n";
+            return;
+        }
+        dir_ = dir;
+        driverHash_ = FNV_OFFSET;
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const char* s = (const char*)glGetString(name);
+            driverHash_ = hash(driverHash_, s ? s : "", s ? std::strlen(s) + 1 : 1);
+        }
+        enabled_ = true;
+        std::cout << "[ProgramCache] Caching program binaries in " << dir << "\n";
+    }
+
+    uint64_t key(std::initializer_list<Stage> stages) const {
+        uint64_t h = driverHash_;
+        for (const Stage& s : stages) {
+            h = hash(h, &s.type, sizeof(s.type));
+            h = hash(h, s.source, std::strlen(s.source) + 1);
+        }
+        return h;
+    }
+
+    // A linked program for `key`, or 0 on a miss.
+    GLuint load(uint64_t key) {
+        if (!enabled_) return 0;
+        std::string path = pathFor(key);
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return 0;
+
+        FileHeader h;
+        std::vector<char> blob;
+        bool ok = std::fread(&h, sizeof(h), 1, f) == 1 && h.magic == MAGIC &&
+                  h.version == VERSION && h.key == key && h.length > 0;
+        if (ok) {
+            blob.resize(h.length);
+            ok = std::fread(blob.data(), 1, h.length, f) == h.length;
+        }
+        std::fclose(f);
+
+        GLuint program = 0;
+        if (ok) {
+            program = glCreateProgram();
+            glProgramBinary(program, h.format, blob.data(), (GLsizei)h.length);
+            GLint linked = 0;
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+            if (!linked) {
+                glDeleteProgram(program);
+                program = 0;
+            }
+        }
+        if (!program) {
+            std::cout << "[ProgramCache] Stale entry " << path << "; recompiling\n";
+            std::remove(path.c_str());
+            return 0;
+        }
+        hits++;
+        return program;
+    }
+
+    // Call between glCreateProgram and glLinkProgram of a program that
+    // will be store()d; some drivers only keep the binary when asked.
+    void prepare(GLuint program) const {
+        if (enabled_) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    // Save a freshly linked program under `key`.
+    void store(uint64_t key, GLuint program) {
+        compiled++;
+        if (!enabled_) return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+
+        FileHeader h;
+        h.key = key;
+        std::vector<char> blob(length);
+        GLsizei written = 0;
+        glGetProgramBinary(program, length, &written, &h.format, blob.data());
+        h.length = (uint32_t)written;
+        if (written <= 0) return;
+
+        std::string path = pathFor(key);
+        std::string tmp  = path + ".tmp";
+        FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (!f) {
+            std::cerr << "[ProgramCache] Cannot write " << tmp << "\n";
+            return;
+        }
+        bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+                  std::fwrite(blob.data(), 1, h.length, f) == h.length;
+        ok = std::fclose(f) == 0 && ok;
+        std::error_code ec;
+        if (ok) std::filesystem::rename(tmp, path, ec);
+        if (!ok || ec) std::remove(tmp.c_str());
+    }
+
+private:
+    static constexpr uint32_t MAGIC       = 0x42505348;   // "HSPB"
+    static constexpr uint32_t VERSION     = 1;
+    static constexpr uint64_t FNV_OFFSET  = 0xcbf29ce484222325ull;
+    static constexpr uint64_t FNV_PRIME   = 0x100000001b3ull;
+
+    struct FileHeader {
+        uint32_t magic   = MAGIC;
+        uint32_t version = VERSION;
+        uint64_t key     = 0;
+        GLenum   format  = 0;
+        uint32_t length  = 0;
+    };
+
+    bool        enabled_    = false;
+    std::string dir_;
+    uint64_t    driverHash_ = FNV_OFFSET;
+
+    static uint64_t hash(uint64_t h, const void* data, size_t size) {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++) {
+            h ^= p[i];
+            h *= FNV_PRIME;
+        }
+        return h;
+    }
+
+    std::string pathFor(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return (std::filesystem::path(dir_) / name).string();
+    }
+};
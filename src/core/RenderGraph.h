@@ -0,0 +1,361 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "core/Buffer.h"
+#include "core/GpuProfiler.h"
+#include "core/Texture2D.h"
+#include "core/Texture3D.h"
+
+// Small frame graph: passes declare what they read and write, the graph
+// places the memory barriers.
+//
+//   RenderGraph& graph = RenderGraph::instance();
+//   bool own = graph.begin();          // false: an outer caller executes
+//   graph.addPass("Advect Velocity")
+//        .read(velSrc).read(walls).write(velDst)
+//        .exec([=] { ... dispatch ... });
+//   if (own) graph.execute();
+//
+// execute() puts every pass on the earliest level after all passes it
+// conflicts with (read-after-write, write-after-write, write-after-read on
+// a shared resource), then runs level by level in recording order. Passes
+// on one level are independent, so they need no barrier between them: one
+// glMemoryBarrier before each level carries exactly the bits the level's
+// consumers need for incoherent (SSBO / image) writes of earlier levels,
+// e.g. STORAGE for an SSBO read, TEXTURE_FETCH for a texture() of an image
+// the previous level stored to. Rasterised attachment writes are coherent
+// and need none. Independent work (Worley slab generation next to the
+// solver) shares a level with the first solver pass instead of forcing a
+// barrier of its own.
+//
+// Write-after-read needs ordering only, which GL provides between commands;
+// only read/write-after-incoherent-write needs a barrier.
+//
+// Consumers outside the graph (raymarcher, readbacks) are not declared, so
+// execute() ends by flushing any still-pending writes with the bits the
+// passes used before the graph existed (STORAGE for SSBOs, IMAGE_ACCESS |
+// TEXTURE_FETCH for images).
+//
+// `fullBarriers` is the debugging switch TODO.md asks for: recording order
+// and GL_ALL_BARRIER_BITS before every pass.
+//
+// Pass callbacks live in fixed inline storage, and passes, resources and
+// levels reuse their vectors, so a steady-state frame does not allocate.
+class RenderGraph {
+public:
+    enum Access : uint8_t {
+        Storage,      // SSBO load/store in a shader
+        Image,        // imageLoad/imageStore
+        Texture,      // sampler fetch
+        Uniform,      // UBO
+        Indirect,     // dispatch/draw indirect arguments
+        Transfer,     // glGetBufferSubData / copies / readback
+        Attachment,   // framebuffer colour/depth target
+    };
+
+    // Captures must fit inline and be trivially copyable (pointers,
+    // references, small values): passes are stored without allocating.
+    class PassFn {
+    public:
+        static constexpr size_t CAPACITY = 96;
+
+        template<typename F>
+        void set(F f) {
+            static_assert(sizeof(F) <= CAPACITY, "RenderGraph pass captures too much; capture pointers");
+            static_assert(std::is_trivially_copyable<F>::value &&
+                          std::is_trivially_destructible<F>::value,
+                          "RenderGraph pass captures must be trivially copyable");
+            new (storage) F(f);
+            invoke = [](void* p) { (*static_cast<F*>(p))(); };
+        }
+
+        void operator()() { if (invoke) invoke(storage); }
+
+    private:
+        alignas(std::max_align_t) unsigned char storage[CAPACITY];
+        void (*invoke)(void*) = nullptr;
+    };
+
+    struct Use {
+        GLuint   id     = 0;
+        bool     buffer = true;     // GL buffer or texture name
+        bool     write  = false;
+        Access   access = Storage;
+    };
+
+    class Pass {
+    public:
+        static constexpr int MAX_USES = 8;
+
+        Pass& read (const SSBOBuffer& b, Access a = Storage) { return use(b.ID, true,  false, a); }
+        Pass& write(const SSBOBuffer& b, Access a = Storage) { return use(b.ID, true,  true,  a); }
+        Pass& read (const Texture2D& t,  Access a = Texture) { return use(t.ID, false, false, a); }
+        Pass& write(const Texture2D& t,  Access a = Image)   { return use(t.ID, false, true,  a); }
+        Pass& read (const Texture3D& t,  Access a = Texture) { return use(t.ID, false, false, a); }
+        Pass& write(const Texture3D& t,  Access a = Image)   { return use(t.ID, false, true,  a); }
+
+        template<typename F>
+        Pass& exec(F f) { fn.set(f); return *this; }
+
+    private:
+        friend class RenderGraph;
+        const char* name  = nullptr;
+        const char* scope = nullptr;   // GpuProfiler scope; consecutive passes share it
+        Use    uses[MAX_USES];
+        int    useCount = 0;
+        int    level    = 0;
+        PassFn fn;
+
+        Pass& use(GLuint id, bool buffer, bool write, Access a) {
+            if (useCount == MAX_USES) {
+                std::cerr << "[RenderGraph] Pass '" << name << "' declares more than "
+                          << MAX_USES << " resources\n";
+                return *this;
+            }
+            Use& u = uses[useCount++];
+            u.id = id; u.buffer = buffer; u.write = write; u.access = a;
+            return *this;
+        }
+    };
+
+    // Pooled 2D textures for one-pass intermediates. A texture handed back
+    // with release() is reused by the next acquire() of the same size and
+    // format, so an intermediate that only some frames need is not held
+    // by its pass in between. Textures unused for IDLE_FRAMES frames
+    // (resized away, or a path switched off) are freed.
+    // allocations() counts the textures created; when it has not changed,
+    // a texture a caller acquired before is still the same GL object, so
+    // e.g. a framebuffer attachment to it need not be redone.
+    class TransientTextures {
+    public:
+        static constexpr uint64_t IDLE_FRAMES = 60;
+
+        const Texture2D& acquire(int w, int h, GLenum format) {
+            Entry* freeSlot = nullptr;
+            for (Entry& e : entries) {
+                if (e.tex.ID == 0) { if (!freeSlot) freeSlot = &e; continue; }
+                if (e.inUse || e.tex.width != w || e.tex.height != h ||
+                    e.tex.internalFormat != format) continue;
+                e.inUse    = true;
+                e.lastUsed = frame;
+                return e.tex;
+            }
+            if (!freeSlot) {
+                entries.emplace_back();   // deque: earlier references stay valid
+                freeSlot = &entries.back();
+            }
+            freeSlot->tex.create(w, h, format);
+            created++;
+            freeSlot->inUse    = true;
+            freeSlot->lastUsed = frame;
+            return freeSlot->tex;
+        }
+
+        uint64_t allocations() const { return created; }
+
+        void release(const Texture2D& tex) {
+            for (Entry& e : entries)
+                if (&e.tex == &tex) e.inUse = false;
+        }
+
+        void endFrame() {
+            frame++;
+            for (Entry& e : entries)
+                if (e.tex.ID && !e.inUse && frame - e.lastUsed > IDLE_FRAMES) e.tex.destroy();
+        }
+
+        void destroy() {
+            for (Entry& e : entries) e.tex.destroy();
+            entries.clear();
+        }
+
+    private:
+        struct Entry {
+            Texture2D tex;
+            bool      inUse    = false;
+            uint64_t  lastUsed = 0;
+        };
+        std::deque<Entry> entries;
+        uint64_t          frame   = 0;
+        uint64_t          created = 0;
+    };
+
+    bool fullBarriers = false;
+    TransientTextures transients;
+
+    static RenderGraph& instance() {
+        static RenderGraph graph;
+        return graph;
+    }
+
+    // Start recording; false if already recording (the caller that got true
+    // executes).
+    bool begin() {
+        if (recording) return false;
+        recording = true;
+        passes.clear();
+        return true;
+    }
+
+    bool isRecording() const { return recording; }
+
+    // `scope` defaults to the pass name.
+    Pass& addPass(const char* name, const char* scope = nullptr) {
+        if (!recording) std::cerr << "[RenderGraph] addPass('" << name << "') outside begin()\n";
+        if (passes.size() == passes.capacity()) passes.reserve(passes.size() * 2 + 64);
+        passes.emplace_back();
+        Pass& p = passes.back();
+        p.name  = name;
+        p.scope = scope ? scope : name;
+        return p;
+    }
+
+    void execute() {
+        recording = false;
+        barrierCount = 0;
+        if (passes.empty()) return;
+
+        schedule();
+
+        GpuProfiler& profiler = GpuProfiler::instance();
+        const char* openScope = nullptr;
+        resources.clear();
+
+        for (int level = 0; level <= maxLevel; level++) {
+            GLbitfield bits = 0;
+            for (size_t i : order[level]) bits |= neededBits(passes[i]);
+            if (fullBarriers) bits = GL_ALL_BARRIER_BITS;
+            if (bits) {
+                glMemoryBarrier(bits);
+                barrierCount++;
+                for (Resource& r : resources) r.visible |= bits;
+            }
+
+            for (size_t i : order[level]) {
+                Pass& p = passes[i];
+                if (!openScope || p.scope != openScope) {
+                    if (openScope) profiler.end();
+                    profiler.begin(p.scope);
+                    openScope = p.scope;
+                }
+                p.fn();
+                for (int u = 0; u < p.useCount; u++) {
+                    if (!p.uses[u].write) continue;
+                    Resource& r = resource(p.uses[u]);
+                    // Attachment writes are coherent; shader stores are not.
+                    r.pending = p.uses[u].access != Attachment;
+                    r.visible = 0;
+                    r.storeBits = p.uses[u].buffer ? GL_SHADER_STORAGE_BARRIER_BIT
+                                                   : GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+                                                     GL_TEXTURE_FETCH_BARRIER_BIT;
+                }
+            }
+        }
+        if (openScope) profiler.end();
+
+        // Flush for readers outside the graph.
+        GLbitfield flush = 0;
+        for (const Resource& r : resources)
+            if (r.pending) flush |= r.storeBits & ~r.visible;
+        if (flush) {
+            glMemoryBarrier(flush);
+            barrierCount++;
+        }
+    }
+
+    // glMemoryBarrier calls made by the last execute().
+    int lastBarrierCount() const { return barrierCount; }
+    int lastPassCount() const { return (int)passes.size(); }
+
+    void endFrame() { transients.endFrame(); }
+
+    void destroy() { transients.destroy(); }
+
+private:
+    struct Resource {
+        GLuint     id        = 0;
+        bool       buffer    = true;
+        bool       pending   = false;   // incoherent write not yet flushed
+        GLbitfield visible   = 0;       // barrier bits issued since that write
+        GLbitfield storeBits = 0;       // flush bits for outside readers
+    };
+
+    std::vector<Pass>     passes;
+    std::vector<Resource> resources;
+    std::vector<std::vector<size_t>> order;   // pass indices per level
+    int  maxLevel     = 0;
+    int  barrierCount = 0;
+    bool recording    = false;
+
+    RenderGraph() = default;
+
+    static GLbitfield bitFor(Access a) {
+        switch (a) {
+        case Storage:    return GL_SHADER_STORAGE_BARRIER_BIT;
+        case Image:      return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+        case Texture:    return GL_TEXTURE_FETCH_BARRIER_BIT;
+        case Uniform:    return GL_UNIFORM_BARRIER_BIT;
+        case Indirect:   return GL_COMMAND_BARRIER_BIT;
+        case Transfer:   return GL_BUFFER_UPDATE_BARRIER_BIT;
+        case Attachment: return GL_FRAMEBUFFER_BARRIER_BIT;
+        }
+        return GL_ALL_BARRIER_BITS;
+    }
+
+    Resource& resource(const Use& u) {
+        for (Resource& r : resources)
+            if (r.id == u.id && r.buffer == u.buffer) return r;
+        Resource r;
+        r.id     = u.id;
+        r.buffer = u.buffer;
+        resources.push_back(r);
+        return resources.back();
+    }
+
+    // Bits `p` needs for writes of earlier levels that it reads or overwrites.
+    GLbitfield neededBits(const Pass& p) {
+        GLbitfield bits = 0;
+        for (int u = 0; u < p.useCount; u++) {
+            const Resource& r = resource(p.uses[u]);
+            if (r.pending) bits |= bitFor(p.uses[u].access) & ~r.visible;
+        }
+        return bits;
+    }
+
+    static bool conflicts(const Pass& a, const Pass& b) {
+        for (int i = 0; i < a.useCount; i++)
+            for (int j = 0; j < b.useCount; j++) {
+                const Use& x = a.uses[i];
+                const Use& y = b.uses[j];
+                if (x.id == y.id && x.buffer == y.buffer && (x.write || y.write)) return true;
+            }
+        return false;
+    }
+
+    void schedule() {
+        maxLevel = 0;
+        for (size_t i = 0; i < passes.size(); i++) {
+            // fullBarriers: one pass per level, in recording order
+            int level = 0;
+            if (fullBarriers) level = (int)i;
+            else
+                for (size_t j = 0; j < i; j++)
+                    if (passes[j].level >= level && conflicts(passes[j], passes[i]))
+                        level = passes[j].level + 1;
+            passes[i].level = level;
+            if (level > maxLevel) maxLevel = level;
+        }
+        if ((int)order.size() <= maxLevel) order.resize(maxLevel + 1);
+        for (int l = 0; l <= maxLevel; l++) order[l].clear();
+        for (size_t i = 0; i < passes.size(); i++) order[passes[i].level].push_back(i);
+    }
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core/FileUtils.h"
+
+#ifdef SMOKE_EMBED_SHADERS
+#include "EmbeddedShaders.h"   // generated by cmake/EmbedShaders.cmake
+#endif
+
+// Shader sources by path from the project root ("shaders/smoke/Raymarch.comp").
+//
+// CMake builds (SMOKE_EMBED_SHADERS, on by default) compile every shader
+// under shaders/ into the binary with its #includes already resolved, so
+// startup opens no files and does not depend on the working directory.
+// With `fromDisk` (--shader-dev, and always in builds without the embedded
+// table, e.g. the makefile) the files are read and resolved at load time
+// instead, so shader edits apply without rebuilding.
+//
+// #include, the same way cmake/EmbedShaders.cmake does it:
+//   - `#include "file"` on its own line, relative to the including file;
+//   - each file is pasted once per shader, later includes of it are dropped;
+//   - a missing file or an include cycle is an error.
+// Shared GLSL lives in shaders/smoke/include/*.glsl.
+class ShaderLibrary {
+public:
+#ifdef SMOKE_EMBED_SHADERS
+    bool fromDisk = false;
+#else
+    bool fromDisk = true;
+#endif
+
+    static ShaderLibrary& instance() {
+        static ShaderLibrary library;
+        return library;
+    }
+
+    static constexpr bool embedded() {
+#ifdef SMOKE_EMBED_SHADERS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // The source of `path` with #includes resolved. Throws
+    // std::runtime_error (like loadTextFile) if it, or an include, is missing.
+    std::string load(const std::string& path) const {
+        std::string key = normalise(path);
+#ifdef SMOKE_EMBED_SHADERS
+        if (!fromDisk) {
+            for (const EmbeddedShaders::File& f : EmbeddedShaders::files)
+                if (key == f.path) return f.source;
+            throw std::runtime_error("[ShaderLibrary] No embedded shader " + key);
+        }
+#endif
+        std::vector<std::string> seen, stack;
+        return resolve(key, seen, stack);
+    }
+
+    // Sorted paths of the shaders in `dir` ("shaders/smoke") ending in `ext`.
+    std::vector<std::string> list(const std::string& dir, const std::string& ext) const {
+        std::vector<std::string> paths;
+        std::string prefix = normalise(dir) + "/";
+#ifdef SMOKE_EMBED_SHADERS
+        if (!fromDisk) {
+            for (const EmbeddedShaders::File& f : EmbeddedShaders::files) {
+                std::string p = f.path;
+                if (p.compare(0, prefix.size(), prefix) == 0 &&
+                    p.find('/', prefix.size()) == std::string::npos &&
+                    std::filesystem::path(p).extension() == ext)
+                    paths.push_back(p);
+            }
+        }
+#endif
+        if (fromDisk) {
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+                if (entry.path().extension() == ext)
+                    paths.push_back(prefix + entry.path().filename().string());
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+private:
+    static std::string normalise(const std::string& path) {
+        std::string p = std::filesystem::path(path).lexically_normal().generic_string();
+        if (!p.empty() && p.back() == '/') p.pop_back();
+        return p;
+    }
+
+    // `seen`: files already pasted into this shader; `stack`: the chain of
+    // files being included, for cycles.
+    static std::string resolve(const std::string& path, std::vector<std::string>& seen,
+                               std::vector<std::string>& stack) {
+        std::string id = std::filesystem::absolute(path).lexically_normal().string();
+        if (std::find(stack.begin(), stack.end(), id) != stack.end())
+            throw std::runtime_error("[ShaderLibrary] Include cycle at " + path);
+        if (std::find(seen.begin(), seen.end(), id) != seen.end()) return "";
+        seen.push_back(id);
+        stack.push_back(id);
+
+        std::string text = loadTextFile(path);
+        text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+        std::filesystem::path dir = std::filesystem::path(path).parent_path();
+
+        std::string out;
+        out.reserve(text.size());
+        size_t at = 0;
+        while (at < text.size()) {
+            size_t eol  = text.find('\n', at);
+            size_t next = eol == std::string::npos ? text.size() : eol + 1;
+            std::string name;
+            if (includeName(text.substr(at, next - at), name)) {
+                std::string included = resolve((dir / name).generic_string(), seen, stack);
+                if (included.empty()) {
+                    // Drop the directive, keep its line break.
+                    if (eol != std::string::npos) out += '\n';
+                } else {
+                    out += included;
+                    if (out.back() != '\n') out += '\n';
+                }
+            } else {
+                out.append(text, at, next - at);
+            }
+            at = next;
+        }
+
+        stack.pop_back();
+        return out;
+    }
+
+    // True if `line` is `#include "name"` (blanks allowed before and after
+    // the '#'), with the quoted name in `name`.
+    static bool includeName(const std::string& line, std::string& name) {
+        size_t i = line.find_first_not_of(" \t");
+        if (i == std::string::npos || line[i] != '#') return false;
+        i = line.find_first_not_of(" \t", i + 1);
+        if (i == std::string::npos || line.compare(i, 7, "include") != 0) return false;
+        i = line.find_first_not_of(" \t", i + 7);
+        if (i == std::string::npos || line[i] != '"') return false;
+        size_t end = line.find('"', i + 1);
+        if (end == std::string::npos || end == i + 1) return false;
+        name = line.substr(i + 1, end - i - 1);
+        return name.find('\n') == std::string::npos;
+    }
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// Startup policy for building programs.
+//
+// ComputeShader::setUp and shader::setUpShader only submit: they compile and
+// link but do not query the result, so the driver can keep building while
+// the next program is submitted. The status check (and the log on failure)
+// happens on the program's first use. With GL_KHR_parallel_shader_compile
+// (or the ARB twin), init() also lets the driver build on as many threads as
+// it likes; without it, deferring the checks still stops every setUp from
+// waiting for its own link.
+//
+// `deferred = false` restores the old check-right-away behaviour, which is
+// the serial baseline (`--serial-shaders`, and `smoke_bench --shaders`).
+class ShaderManager {
+public:
+    bool   deferred  = true;
+    bool   parallel  = false;   // driver compiles on background threads
+    int    submitted = 0;       // programs compiled from source
+    double waitMs    = 0.0;     // time spent blocked in status checks
+
+    static ShaderManager& instance() {
+        static ShaderManager mgr;
+        return mgr;
+    }
+
+    // After the GL loader; `load` resolves the extension entry point.
+    void init(GLADloadproc load) {
+        typedef void (*MaxThreadsFn)(GLuint);
+        MaxThreadsFn maxThreads = nullptr;
+        if (hasExtension("GL_KHR_parallel_shader_compile"))
+            maxThreads = (MaxThreadsFn)load("glMaxShaderCompilerThreadsKHR");
+        else if (hasExtension("GL_ARB_parallel_shader_compile"))
+            maxThreads = (MaxThreadsFn)load("glMaxShaderCompilerThreadsARB");
+        if (maxThreads) {
+            maxThreads(0xFFFFFFFFu);   // implementation-chosen thread count
+            parallel = true;
+        }
+        std::cout << "[ShaderManager] " << (deferred ? "Deferred" : "Immediate")
+                  << " status checks, parallel compile "
+                  << (parallel ? "on" : "not supported") << "\n";
+    }
+
+    // True if `program` has finished linking, without blocking. Always
+    // true when the driver does not compile in parallel.
+    bool completed(GLuint program) const {
+        if (!parallel) return true;
+        GLint done = GL_TRUE;
+        glGetProgramiv(program, COMPLETION_STATUS, &done);
+        return done == GL_TRUE;
+    }
+
+    // Scope that adds its lifetime to waitMs; wraps each status check.
+    struct Wait {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        ~Wait() {
+            instance().waitMs += std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+    };
+
+private:
+    static constexpr GLenum COMPLETION_STATUS = 0x91B1;   // GL_COMPLETION_STATUS_KHR
+
+    static bool hasExtension(const char* name) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (ext && !std::strcmp(ext, name)) return true;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/ShaderLibrary.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Shader hot reload (--hot-reload): watches shaders/ with inotify and
+// rebuilds the compute programs whose source changed, while the app keeps
+// running on the old ones.
+//
+// beginFrame() marks the frame boundary. When a shader file was written
+// since the last one, it bumps generation(); every ComputeShader set up
+// from a file notices on its next use, loads its source again (an edited
+// include reaches every kernel that pastes it) and, if the source differs,
+// submits the build without waiting for it (ShaderManager: parallel compile
+// where the driver has it) and stages it here. Once a whole frame has gone
+// by without a new rebuild being staged and every staged build has linked,
+// beginFrame() swaps them all in together, so an edit to a shared include
+// never runs half old, half new, and a kernel never changes mid-frame. If
+// any of them failed to compile or link, the logs are printed and all the
+// running programs stay. Nothing else is touched: SmokeField and every
+// other buffer keep their contents, so a kernel edit can be compared live
+// in the profiler.
+//
+// Sources are read from disk while watching (ShaderLibrary::fromDisk).
+// Directories created after start() are not watched. Without inotify
+// (anything but Linux) start() reports that and hot reload stays off.
+class ShaderReloader {
+public:
+    int reloaded = 0;   // programs swapped for a rebuilt one
+    int failed   = 0;   // rebuilds that did not compile or link
+
+    // A rebuilt program waiting for the rest of its change set. `owner` is
+    // the ComputeShader, which stages itself while it has one.
+    struct Staged {
+        const void* owner = nullptr;
+        bool (*built)(const void* owner);               // linked, without blocking
+        bool (*check)(const void* owner);               // compiled and linked; logs if not
+        void (*finish)(const void* owner, bool swap);   // swap it in, or drop it
+    };
+
+    static ShaderReloader& instance() {
+        static ShaderReloader reloader;
+        return reloader;
+    }
+
+    bool enabled() const { return fd_ >= 0; }
+
+    // Bumped by beginFrame() when a shader changed.
+    uint32_t generation() const { return generation_; }
+
+    // Before any shader is set up. `dir` is watched with its subdirectories.
+    bool start(const std::string& dir) {
+#ifdef __linux__
+        fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd_ < 0) {
+            std::cerr << "[ShaderReloader] inotify_init1 failed; hot reload off\n";
+            return false;
+        }
+        std::error_code ec;
+        watch(dir);
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dir, ec))
+            if (entry.is_directory()) watch(entry.path().generic_string());
+        if (dirs_.empty()) {
+            std::cerr << "[ShaderReloader] Cannot watch " << dir << "; hot reload off\n";
+            stop();
+            return false;
+        }
+        ShaderLibrary::instance().fromDisk = true;
+        std::cout << "[ShaderReloader] Watching " << dirs_.size() << " director"
+                  << (dirs_.size() == 1 ? "y" : "ies") << " under " << dir << "\n";
+        return true;
+#else
+        (void)dir;
+        std::cerr << "[ShaderReloader] Needs inotify (Linux); hot reload off\n";
+        return false;
+#endif
+    }
+
+    void stop() {
+#ifdef __linux__
+        if (fd_ >= 0) close(fd_);
+#endif
+        fd_ = -1;
+        dirs_.clear();
+    }
+
+    // Start of a frame: drains the watch and bumps generation() if a
+    // shader file was written, then swaps in the staged rebuilds if the
+    // change set is complete.
+    void beginFrame() {
+        frame_++;
+#ifdef __linux__
+        if (fd_ < 0) return;
+        alignas(inotify_event) char buf[4096];
+        bool changed = false;
+        for (;;) {
+            ssize_t len = read(fd_, buf, sizeof(buf));
+            if (len <= 0) break;   // EAGAIN: drained
+            for (char* p = buf; p < buf + len; ) {
+                const inotify_event* ev = (const inotify_event*)p;
+                p += sizeof(inotify_event) + ev->len;
+                if (ev->len == 0 || (ev->mask & IN_ISDIR)) continue;
+                std::string name = ev->name;
+                if (!isShader(name)) continue;   // editor swap and backup files
+                std::cout << "[ShaderReloader] " << dirFor(ev->wd) << "/" << name << " changed\n";
+                changed = true;
+            }
+        }
+        if (changed) generation_++;
+        swapStaged();
+#endif
+    }
+
+    // Replaces `s.owner`'s earlier entry, if any (a newer edit superseded it).
+    void stage(const Staged& s) {
+        lastStaged_ = frame_;
+        for (Staged& e : staged_) {
+            if (e.owner == s.owner) {
+                e = s;
+                return;
+            }
+        }
+        staged_.push_back(s);
+    }
+
+    void unstage(const void* owner) {
+        for (size_t i = 0; i < staged_.size(); i++) {
+            if (staged_[i].owner == owner) {
+                staged_.erase(staged_.begin() + i);
+                return;
+            }
+        }
+    }
+
+private:
+    struct Dir {
+        int         wd;
+        std::string path;
+    };
+
+    int              fd_         = -1;
+    uint32_t         generation_ = 0;
+    uint64_t         frame_      = 0;
+    uint64_t         lastStaged_ = 0;   // frame of the last stage()
+    std::vector<Dir> dirs_;
+    std::vector<Staged> staged_;
+
+    // Kernels stage their rebuild at their first use after a change, so a
+    // whole frame without a new one has to pass before the set is complete.
+    void swapStaged() {
+        if (staged_.empty() || frame_ <= lastStaged_ + 1) return;
+        for (const Staged& s : staged_)
+            if (!s.built(s.owner)) return;
+
+        std::vector<Staged> batch;
+        batch.swap(staged_);
+        int bad = 0;
+        for (const Staged& s : batch)
+            if (!s.check(s.owner)) bad++;
+        for (const Staged& s : batch)
+            s.finish(s.owner, bad == 0);
+
+        if (bad) {
+            failed += bad;
+            std::cout << "[ShaderReloader] " << bad << " of " << batch.size()
+                      << " rebuild(s) failed; keeping the running programs\n";
+        } else {
+            reloaded += (int)batch.size();
+            std::cout << "[ShaderReloader] Swapped in " << batch.size() << " program(s)\n";
+        }
+    }
+
+    void watch(const std::string& path) {
+#ifdef __linux__
+        // Editors either rewrite the file or write a temporary and rename it.
+        int wd = inotify_add_watch(fd_, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd >= 0) dirs_.push_back({ wd, path });
+#else
+        (void)path;
+#endif
+    }
+
+    std::string dirFor(int wd) const {
+        for (const Dir& d : dirs_)
+            if (d.wd == wd) return d.path;
+        return "?";
+    }
+
+    static bool isShader(const std::string& name) {
+        std::string ext = std::filesystem::path(name).extension().string();
+        return ext == ".comp" || ext == ".vert" || ext == ".frag" || ext == ".glsl";
+    }
+};
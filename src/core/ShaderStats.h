@@ -0,0 +1,100 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "core/Buffer.h"
+#include "core/AsyncReadback.h"
+#include "core/Texture2D.h"
+
+// Shader-side hot-path counters (debug builds only).
+//
+// Built with SMOKE_STATS defined, ComputeShader prepends
+// "#define SMOKE_STATS 1" to every kernel, and the kernels bump the atomic
+// counters below in the stats SSBO (binding STATS_BINDING). The raymarch also
+// writes the number of fine steps each ray took into `stepsImage` (R32UI,
+// image unit STEPS_IMAGE_UNIT) for StepsHeatmapView. Without the define the
+// counter code is preprocessed out of the shaders and nothing here is used.
+//
+// Counters are cleared in beginFrame(). collect() copies them out through an
+// AsyncReadback, so `counters` trails the GPU by a frame or two.
+class ShaderStats {
+public:
+    static constexpr GLuint STATS_BINDING    = 7;
+    static constexpr GLuint STEPS_IMAGE_UNIT = 2;
+
+    // Slots of the counter SSBO; must match the STAT_* constants in the shaders.
+    enum Counter {
+        RaysMarched = 0,    // rays that reached the fine accumulation phase
+        FineSteps,          // fine raymarch steps over all rays
+        ShadowSamples,      // shadow-march density samples
+        EarlyTerminated,    // rays stopped by the transmittance cutoff
+        WallVoxelsSkipped,  // solver invocations that returned on a wall voxel
+        MaxRaySteps,        // atomicMax of fine steps on a single ray
+        COUNTER_COUNT
+    };
+
+    Texture2D stepsImage;
+    GLuint    counters[COUNTER_COUNT] = {};   // latest landed readback
+
+    static ShaderStats& instance() {
+        static ShaderStats stats;
+        return stats;
+    }
+
+    void init(int width, int height) {
+        counterBuf.allocate(COUNTER_COUNT * sizeof(GLuint));
+        createTargets(width, height);
+    }
+
+    void resize(int width, int height) {
+        if (width == stepsImage.width && height == stepsImage.height) return;
+        stepsImage.destroy();
+        createTargets(width, height);
+    }
+
+    // Zero counters and the steps image, then bind the counter SSBO for
+    // every kernel this frame.
+    void beginFrame() {
+        counterBuf.clear();
+        GLuint zero = 0;
+        glClearTexImage(stepsImage.ID, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        counterBuf.bindBase(STATS_BINDING);
+    }
+
+    // The raymarch binds its own images every frame; call after it.
+    void bindStepsImage() const {
+        stepsImage.bindImage(STEPS_IMAGE_UNIT, GL_WRITE_ONLY);
+    }
+
+    // Call once per frame after the counted passes: takes the last landed
+    // readback, then queues this frame's counters if nothing is in flight.
+    void collect() {
+        if (readback.ready()) {
+            const GLuint* values = readback.data<GLuint>();
+            for (int i = 0; i < COUNTER_COUNT; i++) counters[i] = values[i];
+        }
+        if (!readback.pending())
+            readback.request(counterBuf, COUNTER_COUNT * sizeof(GLuint));
+    }
+
+    void destroy() {
+        readback.destroy();
+        counterBuf.destroy();
+        stepsImage.destroy();
+    }
+
+private:
+    SSBOBuffer    counterBuf;
+    AsyncReadback readback;
+
+    ShaderStats() = default;
+
+    void createTargets(int w, int h) {
+        stepsImage.create(w, h, GL_R32UI);
+        // Integer textures must not use linear filtering to be complete.
+        glBindTexture(GL_TEXTURE_2D, stepsImage.ID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+};
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "core/ComputeShader.h"
+#include "core/WorkgroupConfig.h"
+
+// One compute kernel source, compiled into variants specialised by injected
+// #defines (grid dimensions, workgroup size, feature toggles), so the
+// compiler folds them to constants and drops dead branches.
+//
+// select() is called with the configuration for the coming dispatches; a
+// configuration seen before is a lookup (no allocation), a new one is
+// compiled on the spot (through ProgramCache and ShaderManager like any
+// other program) and kept. use()/dispatch() go to the selected variant.
+// Variants are never moved, so a shader select() returned stays valid
+// until destroy().
+// Each variant is set up from the file, so hot reload rebuilds them all.
+//
+// The source decides what a define does, and must still build without it,
+// e.g. `#ifdef SMOKE_GRID_X ... #else #define GRID_SIZE u_GridSize #endif`.
+//
+// `local`, if set, is added to every configuration as SMOKE_LOCAL_X/Y/Z
+// (the workgroup size); it starts from WorkgroupConfig's tuned value.
+class ShaderVariants {
+public:
+    static constexpr int MAX_DEFINES = 12;
+
+    struct Define {
+        const char* name  = nullptr;   // a string literal
+        int         value = 0;
+    };
+
+    // A configuration: (name, value) pairs, compared in order.
+    struct Spec {
+        Define defines[MAX_DEFINES];
+        int    count = 0;
+
+        Spec& set(const char* name, int value) {
+            for (int i = 0; i < count; i++) {
+                if (std::strcmp(defines[i].name, name) == 0) {
+                    defines[i].value = value;
+                    return *this;
+                }
+            }
+            if (count == MAX_DEFINES) {
+                // Dropping it would compile a variant without the define.
+                static bool reported = false;
+                if (!reported) {
+                    std::cerr << "[ShaderVariants] More than " << MAX_DEFINES
+                              << " defines; " << name << " dropped, raise MAX_DEFINES\n";
+                    reported = true;
+                }
+                return *this;
+            }
+            defines[count++] = { name, value };
+            return *this;
+        }
+
+        bool operator==(const Spec& o) const {
+            if (count != o.count) return false;
+            for (int i = 0; i < count; i++) {
+                if (defines[i].value != o.defines[i].value ||
+                    std::strcmp(defines[i].name, o.defines[i].name) != 0) return false;
+            }
+            return true;
+        }
+    };
+
+    glm::ivec3 local{0};   // workgroup size override; 0 = the shader's own
+
+    // Nothing is loaded or compiled until the first select().
+    void setUpFromFile(const std::string& path) {
+        path_ = path;
+        name_ = std::filesystem::path(path).stem().string();
+        local = WorkgroupConfig::instance().lookup(name_);
+    }
+
+    const ComputeShader& select(const Spec& requested) {
+        requested_ = requested;
+        Spec spec = requested;
+        if (local.x > 0) {
+            spec.set("SMOKE_LOCAL_X", local.x)
+                .set("SMOKE_LOCAL_Y", local.y)
+                .set("SMOKE_LOCAL_Z", local.z);
+        }
+
+        if (current_ < variants_.size() && variants_[current_].spec == spec)
+            return variants_[current_].shader;
+        for (size_t i = 0; i < variants_.size(); i++) {
+            if (variants_[i].spec == spec) {
+                current_ = i;
+                return variants_[i].shader;
+            }
+        }
+        current_ = variants_.size();
+        variants_.push_back({ spec, ComputeShader() });
+        compile(variants_.back());
+        return variants_.back().shader;
+    }
+
+    // Selects again with the last requested configuration, e.g. after
+    // changing `local`.
+    const ComputeShader& reselect() { return select(requested_); }
+
+    // File name without directory and extension ("PressureJacobi").
+    const std::string& name() const { return name_; }
+
+    // The selected variant (an empty, invalid shader before any select()).
+    const ComputeShader& current() const {
+        static const ComputeShader none;
+        return current_ < variants_.size() ? variants_[current_].shader : none;
+    }
+
+    size_t variantCount() const { return variants_.size(); }
+
+    // Deletes the programs of the variants added since variantCount() was
+    // `first`, except the selected one, e.g. an autotuner's losing sizes.
+    // The entries stay (shaders select() returned remain valid objects) but
+    // never match again; selecting such a configuration compiles it anew.
+    void release(size_t first) {
+        for (size_t i = first; i < variants_.size(); i++) {
+            Variant& v = variants_[i];
+            if (i == current_ || v.spec.count < 0) continue;
+            if (v.shader.ID) glDeleteProgram(v.shader.ID);
+            v.shader.ID    = 0;
+            v.shader.valid = false;
+            v.spec.count   = -1;
+        }
+    }
+
+    void use() const { current().use(); }
+
+    void dispatch(int totalX, int totalY = 1, int totalZ = 1) const {
+        current().dispatch(totalX, totalY, totalZ);
+    }
+
+    void destroy() {
+        for (Variant& v : variants_)
+            if (v.shader.ID) glDeleteProgram(v.shader.ID);
+        variants_.clear();
+        current_ = 0;
+    }
+
+private:
+    struct Variant {
+        Spec          spec;
+        ComputeShader shader;
+    };
+
+    std::string          path_;
+    std::string          name_;
+    Spec                 requested_;
+    std::deque<Variant>  variants_;
+    size_t               current_ = 0;
+
+    void compile(Variant& v) {
+        std::string defines;
+        std::string label = path_;
+        for (int i = 0; i < v.spec.count; i++) {
+            const Define& d = v.spec.defines[i];
+            defines += std::string("#define ") + d.name + " " + std::to_string(d.value) + "\n";
+            label   += (i ? " " : " [") + std::string(d.name) + "=" + std::to_string(d.value);
+        }
+        if (v.spec.count) label += "]";
+        v.shader.setUpFromFile(path_, defines, label);
+    }
+};
@@ -8,16 +8,18 @@ class Texture2D {
 public:
     unsigned int ID = 0;
     int width = 0, height = 0;
+    int levels = 1;
     GLenum internalFormat = 0;
 
     // Create immutable 2D texture with glTexStorage2D
-    void create(int w, int h, GLenum format) {
+    void create(int w, int h, GLenum format, int mipLevels = 1) {
         width = w; height = h;
+        levels = mipLevels;
         internalFormat = format;
 
         glGenTextures(1, &ID);
         glBindTexture(GL_TEXTURE_2D, ID);
-        glTexStorage2D(GL_TEXTURE_2D, 1, format, w, h);
+        glTexStorage2D(GL_TEXTURE_2D, mipLevels, format, w, h);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -27,8 +29,8 @@ public:
     }
 
     // Bind as image for compute shader read/write
-    void bindImage(GLuint unit, GLenum access) const {
-        glBindImageTexture(unit, ID, 0, GL_FALSE, 0, access, internalFormat);
+    void bindImage(GLuint unit, GLenum access, int level = 0) const {
+        glBindImageTexture(unit, ID, level, GL_FALSE, 0, access, internalFormat);
     }
 
     // Bind as sampler for texture() lookups
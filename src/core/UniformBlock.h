@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+
+#include "core/FrameRingBuffer.h"
+
+// std140 parameter blocks for compute passes.
+//
+// A pass mirrors its shader's `layout(std140, binding = PASS_PARAMS_BINDING)
+// uniform ...` block as a plain C++ struct, fills it on the CPU and hands it
+// to UniformBlock::bind(), which copies it into this frame's FrameRingBuffer
+// slot and binds that range. One memcpy and one glBindBufferRange replace a
+// glGetUniformLocation + glUniform* pair (and a std::string) per parameter.
+//
+// Members are packed by hand in 16-byte rows (vec3/ivec3 followed by a
+// scalar, mat4 as four rows) so the C++ and std140 layouts agree without
+// alignas; STD140_OFFSET pins every row start so a reordered member fails to
+// compile instead of silently reading garbage on the GPU.
+#define STD140_OFFSET(T, member, offset) \
+    static_assert(offsetof(T, member) == (offset), #T "::" #member " is not at std140 offset " #offset)
+
+#define STD140_SIZE(T, size)                                              \
+    static_assert(sizeof(T) == (size), #T " does not match its std140 block size"); \
+    static_assert(sizeof(T) % 16 == 0, #T " must be padded to a multiple of 16 bytes")
+
+namespace UniformBlock {
+
+// Every converted pass reads its parameters from this binding; passes run
+// one after another, so they can share it.
+constexpr GLuint PASS_PARAMS_BINDING = 0;
+
+// Where a written block lives: a slice of this frame's ring slot or, if the
+// slot was full, the dedicated fallback UBO of its type.
+struct Block {
+    FrameRingBuffer::Slice slice;
+    GLuint                 fallback = 0;
+};
+
+// One UBO per parameter type, filled with glBufferSubData when the ring slot
+// overflows (as FrameRingBuffer::upload falls back), so a pass never runs on
+// whatever block another pass left at its binding. Slow path only: a later
+// overflowing write of the same type replaces the contents.
+template<typename T>
+inline GLuint fallbackBuffer(const T& params) {
+    static GLuint ubo = 0;
+    if (!ubo) {
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+    } else {
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    }
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &params);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return ubo;
+}
+
+// Copy `params` into the ring; the block can be bound any number of times
+// this frame (e.g. across Jacobi iterations) without another copy.
+template<typename T>
+inline Block write(const T& params) {
+    Block b;
+    b.slice = FrameRingBuffer::instance().write(params);
+    if (!b.slice) b.fallback = fallbackBuffer(params);   // overflow already reported
+    return b;
+}
+
+inline void bind(const Block& block, GLuint binding = PASS_PARAMS_BINDING) {
+    if (block.slice)
+        FrameRingBuffer::instance().bindRange(GL_UNIFORM_BUFFER, binding, block.slice);
+    else
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, block.fallback);
+}
+
+template<typename T>
+inline void bind(const T& params, GLuint binding = PASS_PARAMS_BINDING) {
+    bind(write(params), binding);
+}
+
+} // namespace UniformBlock
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Workgroup sizes chosen by the autotuners (WorkgroupTuner.h), per
+// kernel and GPU, kept in a small text file next to the shader cache:
+//
+//   # kernel x y z | GL_RENDERER | GL_VERSION
+//   PressureJacobi 16 8 4 | NVIDIA GeForce RTX 3070/PCIe/SSE2 | 4.6.0 NVIDIA 560.94
+//
+// load() keeps only the lines for the current renderer and driver version;
+// save() rewrites the file with the other GPUs' lines untouched.
+// ShaderVariants::setUpFromFile() asks lookup() for its kernel, so load()
+// must run before the kernels are set up.
+class WorkgroupConfig {
+public:
+    static WorkgroupConfig& instance() {
+        static WorkgroupConfig config;
+        return config;
+    }
+
+    void load(const std::string& path) {
+        path_ = path;
+        gpu_  = glString(GL_RENDERER) + " | " + glString(GL_VERSION);
+        entries_.clear();
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            Entry e;
+            if (!parse(line, e) || e.gpu != gpu_) continue;
+            entries_.push_back(e);
+        }
+        if (!entries_.empty())
+            std::cout << "[WorkgroupConfig] " << entries_.size() << " tuned kernel(s) from "
+                      << path << "\n";
+    }
+
+    // Tuned size for `kernel` on this GPU, or (0, 0, 0) for the shader's own.
+    glm::ivec3 lookup(const std::string& kernel) const {
+        for (const Entry& e : entries_)
+            if (e.kernel == kernel) return e.local;
+        return glm::ivec3(0);
+    }
+
+    void set(const std::string& kernel, const glm::ivec3& local) {
+        for (Entry& e : entries_) {
+            if (e.kernel == kernel) {
+                e.local = local;
+                return;
+            }
+        }
+        entries_.push_back({ kernel, local, gpu_ });
+    }
+
+    bool save() const {
+        if (path_.empty()) return false;
+        std::vector<std::string> others;
+        {
+            std::ifstream in(path_);
+            std::string line;
+            Entry e;
+            while (std::getline(in, line))
+                if (parse(line, e) && e.gpu != gpu_) others.push_back(line);
+        }
+        std::ofstream out(path_);
+        if (!out.is_open()) {
+            std::cerr << "[WorkgroupConfig] Cannot write " << path_ << "\n";
+            return false;
+        }
+        out << "# kernel x y z | GL_RENDERER | GL_VERSION\n";
+        for (const std::string& line : others) out << line << "\n";
+        for (const Entry& e : entries_)
+            out << e.kernel << " " << e.local.x << " " << e.local.y << " " << e.local.z
+                << " | " << e.gpu << "\n";
+        std::cout << "[WorkgroupConfig] Saved " << entries_.size() << " kernel(s) to "
+                  << path_ << "\n";
+        return true;
+    }
+
+private:
+    struct Entry {
+        std::string kernel;
+        glm::ivec3  local{0};
+        std::string gpu;
+    };
+
+    std::string        path_;
+    std::string        gpu_;
+    std::vector<Entry> entries_;
+
+    static std::string glString(GLenum name) {
+        const char* s = (const char*)glGetString(name);
+        return s ? s : "";
+    }
+
+    static bool parse(const std::string& line, Entry& e) {
+        if (line.empty() || line[0] == '#') return false;
+        size_t bar = line.find(" | ");
+        if (bar == std::string::npos) return false;
+        std::istringstream head(line.substr(0, bar));
+        if (!(head >> e.kernel >> e.local.x >> e.local.y >> e.local.z)) return false;
+        e.gpu = line.substr(bar + 3);
+        return e.local.x > 0 && e.local.y > 0 && e.local.z > 0;
+    }
+};
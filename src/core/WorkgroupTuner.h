@@ -0,0 +1,102 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "core/ShaderVariants.h"
+#include "core/WorkgroupConfig.h"
+
+// Picks a kernel's workgroup size by timing it (SmokeSolver::autotune,
+// Raymarcher::autotune). tune() builds every candidate as a ShaderVariants
+// variant, times `run` with each, keeps the fastest selected, records it in
+// WorkgroupConfig (the caller saves) and deletes the losing programs.
+// Blocks on GPU queries; call between frames' GPU scopes, not inside one.
+namespace WorkgroupTuner {
+
+constexpr int WARMUP  = 3;
+constexpr int REPS    = 20;   // dispatches per timed sample
+constexpr int SAMPLES = 3;    // best of
+
+// The candidates within this GPU's workgroup size and invocation limits.
+template<size_t N>
+std::vector<glm::ivec3> supported(const glm::ivec3 (&candidates)[N]) {
+    GLint maxSize[3], maxInvocations = 0;
+    for (int i = 0; i < 3; i++) glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, i, &maxSize[i]);
+    glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &maxInvocations);
+    std::vector<glm::ivec3> out;
+    for (const glm::ivec3& c : candidates) {
+        if (c.x <= maxSize[0] && c.y <= maxSize[1] && c.z <= maxSize[2] &&
+            c.x * c.y * c.z <= maxInvocations)
+            out.push_back(c);
+    }
+    return out;
+}
+
+// GPU ms per call of `run`, best of SAMPLES samples. A barrier follows
+// each call, as between the graph's levels.
+template<typename F>
+double timePerDispatchMs(GLuint query, F&& run) {
+    for (int i = 0; i < WARMUP; i++) {
+        run();
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+    double best = 1e30;
+    for (int s = 0; s < SAMPLES; s++) {
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        for (int i = 0; i < REPS; i++) {
+            run();
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+        best = std::min(best, (double)ns * 1e-6 / REPS);
+    }
+    return best;
+}
+
+// `run` dispatches v's selected variant. False if no candidate built, in
+// which case v keeps its previous size.
+template<typename F>
+bool tune(ShaderVariants& v, const std::vector<glm::ivec3>& candidates, GLuint query, F&& run) {
+    const glm::ivec3 previous = v.local;
+    const size_t     first    = v.variantCount();
+
+    // Submit every candidate first so the driver can build them together.
+    for (const glm::ivec3& c : candidates) {
+        v.local = c;
+        v.reselect();
+    }
+
+    glm::ivec3 best = previous;
+    double bestMs = 1e30;
+    for (const glm::ivec3& c : candidates) {
+        v.local = c;
+        if (!v.reselect().ready()) continue;
+        double ms = timePerDispatchMs(query, run);
+        if (ms < bestMs) {
+            bestMs = ms;
+            best   = c;
+        }
+    }
+    v.local = best;
+    v.reselect();
+    v.release(first);
+    if (bestMs >= 1e30) return false;
+
+    WorkgroupConfig::instance().set(v.name(), best);
+    std::ostringstream line;
+    line << "[Autotune]   " << std::left << std::setw(18) << v.name() << std::right << " "
+         << std::setw(2) << best.x << "x" << best.y << "x" << best.z << "  "
+         << std::fixed << std::setprecision(4) << bestMs << " ms\n";
+    std::cout << line.str();
+    return true;
+}
+
+} // namespace WorkgroupTuner
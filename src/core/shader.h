@@ -8,86 +8,137 @@
 #include <iostream>
 #include <string>
 
+#include "core/ProgramCache.h"
+#include "core/ShaderManager.h"
+
 class shader {
 
 public:
     unsigned int ID = 0;
 
+    // Checks the link on first use when ShaderManager defers status checks.
     void use() {
+        if (pending_) checkLink();
         glUseProgram(ID);
     }
 
     // Uniform setters
-    void setInt(const std::string& name, int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    void setInt(const char* name, int value) const {
+        glUniform1i(glGetUniformLocation(ID, name), value);
     }
-    void setFloat(const std::string& name, float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    void setFloat(const char* name, float value) const {
+        glUniform1f(glGetUniformLocation(ID, name), value);
     }
-    void setVec3(const std::string& name, const glm::vec3& v) const {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(v));
+    void setVec3(const char* name, const glm::vec3& v) const {
+        glUniform3fv(glGetUniformLocation(ID, name), 1, glm::value_ptr(v));
     }
-    void setVec4(const std::string& name, const glm::vec4& v) const {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(v));
+    void setVec4(const char* name, const glm::vec4& v) const {
+        glUniform4fv(glGetUniformLocation(ID, name), 1, glm::value_ptr(v));
     }
-    void setMat4(const std::string& name, const glm::mat4& m) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(m));
+    void setMat4(const char* name, const glm::mat4& m) const {
+        glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(m));
     }
-    void setIVec3(const std::string& name, const glm::ivec3& v) const {
-        glUniform3iv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(v));
+    void setIVec3(const char* name, const glm::ivec3& v) const {
+        glUniform3iv(glGetUniformLocation(ID, name), 1, glm::value_ptr(v));
     }
 
     void setUpShader(const char* vertexShaderSource, const char* fragmentShaderSource) {
-        unsigned int vs = compileStage(GL_VERTEX_SHADER, vertexShaderSource, "VERTEX");
-        unsigned int fs = compileStage(GL_FRAGMENT_SHADER, fragmentShaderSource, "FRAGMENT");
+        ProgramCache& cache = ProgramCache::instance();
+        uint64_t key = cache.key({ { GL_VERTEX_SHADER, vertexShaderSource },
+                                   { GL_FRAGMENT_SHADER, fragmentShaderSource } });
+        if ((ID = cache.load(key)) != 0) return;
+
+        unsigned int vs = compileStage(GL_VERTEX_SHADER, vertexShaderSource);
+        unsigned int fs = compileStage(GL_FRAGMENT_SHADER, fragmentShaderSource);
 
         ID = glCreateProgram();
         glAttachShader(ID, vs);
         glAttachShader(ID, fs);
-        linkProgram();
+        cache.prepare(ID);
+        linkProgram(key);
         glDeleteShader(vs);
         glDeleteShader(fs);
     }
 
     void setUpShader(const char* vertexShaderSource, const char* fragmentShaderSource, const char* geometryShaderSource) {
-        unsigned int vs = compileStage(GL_VERTEX_SHADER, vertexShaderSource, "VERTEX");
-        unsigned int fs = compileStage(GL_FRAGMENT_SHADER, fragmentShaderSource, "FRAGMENT");
-        unsigned int gs = compileStage(GL_GEOMETRY_SHADER, geometryShaderSource, "GEOMETRY");
+        ProgramCache& cache = ProgramCache::instance();
+        uint64_t key = cache.key({ { GL_VERTEX_SHADER, vertexShaderSource },
+                                   { GL_FRAGMENT_SHADER, fragmentShaderSource },
+                                   { GL_GEOMETRY_SHADER, geometryShaderSource } });
+        if ((ID = cache.load(key)) != 0) return;
+
+        unsigned int vs = compileStage(GL_VERTEX_SHADER, vertexShaderSource);
+        unsigned int fs = compileStage(GL_FRAGMENT_SHADER, fragmentShaderSource);
+        unsigned int gs = compileStage(GL_GEOMETRY_SHADER, geometryShaderSource);
 
         ID = glCreateProgram();
         glAttachShader(ID, vs);
         glAttachShader(ID, fs);
         glAttachShader(ID, gs);
-        linkProgram();
+        cache.prepare(ID);
+        linkProgram(key);
         glDeleteShader(vs);
         glDeleteShader(fs);
         glDeleteShader(gs);
     }
 
 private:
-    unsigned int compileStage(GLenum type, const char* source, const char* label) {
+    bool     pending_ = false;   // linked but not yet checked
+    uint64_t key_     = 0;       // ProgramCache key
+
+    unsigned int compileStage(GLenum type, const char* source) {
         unsigned int s = glCreateShader(type);
         glShaderSource(s, 1, &source, NULL);
         glCompileShader(s);
-        int success;
-        char infoLog[1024];
-        glGetShaderiv(s, GL_COMPILE_STATUS, &success);
-        if (!success) {
-            glGetShaderInfoLog(s, 1024, NULL, infoLog);
-            std::cout << "ERROR::SHADER::" << label << "::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
         return s;
     }
 
-    void linkProgram() {
+    // The stages stay attached (deleting them only flags them) until
+    // checkLink() has read their logs.
+    void linkProgram(uint64_t key) {
         glLinkProgram(ID);
+        key_     = key;
+        pending_ = true;
+        ShaderManager& mgr = ShaderManager::instance();
+        mgr.submitted++;
+        if (!mgr.deferred) checkLink();
+    }
+
+    void checkLink() {
+        pending_ = false;
+        ShaderManager::Wait wait;
+        GLuint stages[3];
+        GLsizei count = 0;
+        glGetAttachedShaders(ID, 3, &count, stages);
+
         int success;
         char infoLog[1024];
+        for (GLsizei i = 0; i < count; i++) {
+            glGetShaderiv(stages[i], GL_COMPILE_STATUS, &success);
+            if (!success) {
+                GLint type = 0;
+                glGetShaderiv(stages[i], GL_SHADER_TYPE, &type);
+                glGetShaderInfoLog(stages[i], 1024, NULL, infoLog);
+                std::cout << "ERROR::SHADER::" << stageLabel(type) << "::COMPILATION_FAILED\n"
+                          << infoLog << std::endl;
+            }
+        }
         glGetProgramiv(ID, GL_LINK_STATUS, &success);
         if (!success) {
             glGetProgramInfoLog(ID, 1024, NULL, infoLog);
             std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
         }
+        for (GLsizei i = 0; i < count; i++) glDetachShader(ID, stages[i]);
+        if (success) ProgramCache::instance().store(key_, ID);
+    }
+
+    static const char* stageLabel(GLint type) {
+        switch (type) {
+        case GL_VERTEX_SHADER:   return "VERTEX";
+        case GL_FRAGMENT_SHADER: return "FRAGMENT";
+        case GL_GEOMETRY_SHADER: return "GEOMETRY";
+        default:                 return "STAGE";
+        }
     }
 };
 
@@ -81,7 +81,7 @@ void SmokeField::clear() {
 
     divergence.clear();
 
-    std::cout << "[SmokeField] Cleared all buffers." << std::endl;
+    std::cout << "[SmokeField] Cleared all buffers.\n";
 }
 
 void SmokeField::destroy() {
@@ -96,5 +96,5 @@ void SmokeField::destroy() {
 
     divergence.destroy();
 
-    std::cout << "[SmokeField] Destroyed all buffers." << std::endl;
+    std::cout << "[SmokeField] Destroyed all buffers.\n";
 }
\ No newline at end of file
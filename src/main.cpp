@@ -7,6 +7,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
 #include <iostream>
 #include <vector>
 
@@ -22,6 +23,11 @@
 #include "Debugtest/NoiseDebugView.h"     // NoiseDebugView (Worley slice visualizer)
 #include "Debugtest/VelocityDebugView.h"
 #include "Debugtest/DepthDebugView.h"      // DepthDebugView (linearized depth visualizer)
+#include "Debugtest/GpuProfilerOverlay.h"  // GpuProfilerOverlay (per-pass GPU timings)
+#ifdef SMOKE_STATS
+#include "Debugtest/StepsHeatmapView.h"    // StepsHeatmapView (raymarch steps per ray)
+#include "core/ShaderStats.h"
+#endif
 
 #include "core/ComputeShader.h"
 #include "core/Buffer.h"
@@ -29,6 +35,19 @@
 #include "core/Texture2D.h"
 #include "core/Framebuffer.h"
 #include "core/FullscreenQuad.h"
+#include "core/GpuProfiler.h"
+#include "core/FrameTrace.h"
+#include "core/AsyncReadback.h"
+#include "core/FrameRingBuffer.h"
+#include "core/RenderGraph.h"
+#include "core/Headless.h"                 // --headless offscreen runs
+#include "core/InputTimeline.h"            // --record / --replay input timelines
+#include "core/ProgramCache.h"              // on-disk program binaries
+#include "core/ShaderManager.h"             // deferred / parallel shader builds
+#include "core/ShaderLibrary.h"             // embedded shader sources, --shader-dev
+#include "core/ShaderReloader.h"            // --hot-reload
+#include "core/WorkgroupConfig.h"           // tuned solver and raymarch workgroup sizes
+#include "core/AllocCheck.h"               // defines operator new in SMOKE_ALLOC_CHECK builds
 #include "core/smokeField.h"
 
 #include "Procedural/WorleyNoise.h"
@@ -40,7 +59,11 @@
 
 #include "SmokeSolver/SmokeSolver.h"
 #include "core/SceneDepthPass.h"
+#include "Rendering/DepthPyramid.h"
 #include "Rendering/Raymarcher.h"
+#include "Rendering/DynamicResolution.h"
+#include "Rendering/TemporalUpscaler.h"
+#include "Rendering/EdgeRefinePass.h"
 #include "Rendering/LightSource.h"
 #include "post/Upsampler.h"
 #include "post/Compositor.h"
@@ -61,10 +84,28 @@ static SmokeSolver*     g_solver      = nullptr;
 static NoiseDebugView    g_noiseView;
 static VelocityDebugView g_velocityDebug;
 static DepthDebugView    g_depthDebug;
+static GpuProfilerOverlay g_profilerOverlay;
+#ifdef SMOKE_STATS
+static StepsHeatmapView  g_stepsHeatmap;
+#endif
 static SceneDepthPass*   g_depthPass = nullptr;
 static bool              g_raymarchEnabled = true;
 static std::vector<int>  g_wallVoxelCache;
+static AsyncReadback     g_wallVoxelReadback;   // in-flight refresh of g_wallVoxelCache
 static LightSource       g_light;
+static bool              g_lightDragged = false;   // log the new position once, on release
+static InputTimeline     g_timeline;               // --record / --replay
+
+// Copy a finished wall readback into g_wallVoxelCache. Polls by default;
+// `block` waits for it (picking needs the data right now).
+static void syncWallVoxelCache(bool block) {
+    if (!g_wallVoxelReadback.pending()) return;
+    if (block ? g_wallVoxelReadback.wait() : g_wallVoxelReadback.ready()) {
+        // Resizes the cache when the arena changed size
+        AllocCheck::instance().exemptFrame();
+        g_wallVoxelReadback.copyTo(g_wallVoxelCache);
+    }
+}
 
 // Ray-AABB slab intersection. Returns true on hit with [tEnter, tExit].
 static bool rayIntersectsAABB(const glm::vec3& rayOrigin,
@@ -91,15 +132,20 @@ static bool rayIntersectsAABB(const glm::vec3& rayOrigin,
 // GLFW callbacks
 //---------------------------------------------------------------------
 static void framebuffer_size_callback(GLFWwindow*, int w, int h) {
+    CpuTraceScope trace("framebuffer_size_callback");
     glViewport(0, 0, w, h);
     winWidth  = (unsigned int)w;
     winHeight = (unsigned int)h;
 }
 
 static void key_callback(GLFWwindow* window, int key, int /*scan*/, int action, int /*mods*/) {
+    CpuTraceScope trace("key_callback");
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
+    // A replay owns every toggle; only Escape gets through.
+    if (g_timeline.replaying()) return;
+
     // Noise debug toggle
     if (key == GLFW_KEY_N && action == GLFW_PRESS) {
         g_noiseView.enabled = !g_noiseView.enabled;
@@ -162,11 +208,40 @@ static void key_callback(GLFWwindow* window, int key, int /*scan*/, int action,
         std::cout << "Depth (framebuffer) debug: " << (g_depthDebug.enabled ? "ON" : "OFF") << "\n";
     }
 
+    // GPU profiler overlay toggle
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+        g_profilerOverlay.enabled = !g_profilerOverlay.enabled;
+
+#ifdef SMOKE_STATS
+    // Raymarch steps heatmap toggle
+    if (key == GLFW_KEY_H && action == GLFW_PRESS) {
+        g_stepsHeatmap.enabled = !g_stepsHeatmap.enabled;
+
+        // Keep debug views mutually exclusive
+        if (g_stepsHeatmap.enabled) {
+            g_noiseView.enabled     = false;
+            g_velocityDebug.enabled = false;
+            g_depthDebug.enabled    = false;
+        }
+
+        std::cout << "Steps heatmap: " << (g_stepsHeatmap.enabled ? "ON" : "OFF") << "\n";
+    }
+#endif
+
 }
 
 static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    CpuTraceScope trace("mouse_button_callback");
     g_camera.onMouseButton(button, action);
 
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE && g_lightDragged) {
+        g_lightDragged = false;
+        std::cout << "[Light] pos=("
+                  << g_light.position.x << ", "
+                  << g_light.position.y << ", "
+                  << g_light.position.z << ")\n";
+    }
+
     // Right click: seed smoke at clicked point in the voxel domain.
     if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS) {
         if (!g_voxelizer || !g_floodFill) return;
@@ -190,6 +265,7 @@ static void mouse_button_callback(GLFWwindow* window, int button, int action, in
         glm::vec3 rayOrigin = glm::vec3(invView[3]);
 
         const VoxelDomain& domain = g_voxelizer->domain;
+        syncWallVoxelCache(true);
 
         float tEnter = 0.0f, tExit = 0.0f;
         if (!rayIntersectsAABB(rayOrigin, rayDir, domain.boundsMin, domain.boundsMax, tEnter, tExit)) {
@@ -220,10 +296,12 @@ static void mouse_button_callback(GLFWwindow* window, int button, int action, in
                     glm::vec3 seedPos = domain.gridToWorldCenter(glm::vec3(lastAirVoxel));
                     if ((mods & GLFW_MOD_SHIFT) && g_solver) {
                         g_solver->activateVacuum(seedPos);
+                        g_timeline.record(InputTimeline::Vacuum, &seedPos.x, 3);
                         std::cout << "[Vacuum] Activated at ("
                                   << seedPos.x << ", " << seedPos.y << ", " << seedPos.z << ")\n";
                     } else {
                         g_floodFill->seed(seedPos, domain.gridSize, domain.boundsMin, domain.voxelSize);
+                        g_timeline.record(InputTimeline::Seed, &seedPos.x, 3);
                     }
                     seeded = true;
                     break;
@@ -241,6 +319,7 @@ static void mouse_button_callback(GLFWwindow* window, int button, int action, in
 }
 
 static void cursor_pos_callback(GLFWwindow* window, double x, double y) {
+    CpuTraceScope trace("cursor_pos_callback");
     float fx = (float)x, fy = (float)y;
 
     // Hold L + left-drag: unproject mouse onto a horizontal plane at the
@@ -273,10 +352,7 @@ static void cursor_pos_callback(GLFWwindow* window, double x, double y) {
                 g_light.position.z = hit.z;
                 g_light.orbitEnabled = false;
                 g_light.syncAngles();   // keep ImGui sliders in sync
-                std::cout << "[Light] pos=("
-                          << g_light.position.x << ", "
-                          << g_light.position.y << ", "
-                          << g_light.position.z << ")\n";
+                g_lightDragged = true;
             }
         }
         return;
@@ -286,6 +362,7 @@ static void cursor_pos_callback(GLFWwindow* window, double x, double y) {
 }
 
 static void scroll_callback(GLFWwindow* window, double, double dy) {
+    CpuTraceScope trace("scroll_callback");
     if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS) {
         g_light.position.y += (float)dy * 0.2f;
         g_light.orbitEnabled = false;
@@ -305,6 +382,8 @@ static void rebuildArena(
     SmokeField& smoke,
     float voxelSize,
     int gridX, int gridY, int gridZ) {
+    AllocCheck::instance().exemptFrame();
+
     // destroy bound objects as they contain references which we are currently using.
     smoke.destroy();
     floodFill.destroy();
@@ -313,8 +392,8 @@ static void rebuildArena(
     // Rebuild voxel arena
     voxelizer.generateTestScene(voxelSize, gridX, gridY, gridZ);
 
-    // Refresh CPU cache used by mouse picking / seeding
-    g_wallVoxelCache = voxelizer.staticVoxels.download<int>(voxelizer.domain.totalVoxels);
+    // Refresh CPU cache used by mouse picking / seeding (lands a frame or so later)
+    g_wallVoxelReadback.request(voxelizer.staticVoxels, voxelizer.domain.totalVoxels * sizeof(int));
 
     // Reinit floodfill and smoke
     floodFill.init(voxelizer.domain.totalVoxels);
@@ -329,7 +408,7 @@ static void rebuildArena(
               << voxelizer.domain.gridSize.y << "x"
               << voxelizer.domain.gridSize.z
               << " @ voxelSize=" << voxelizer.domain.voxelSize
-              << std::endl;
+              << "\n";
 }
 
 //---------------------------------------------------------------------
@@ -352,12 +431,118 @@ static void rebuildSceneFBO(Framebuffer& fbo,
 }
 
 //---------------------------------------------------------------------
-// main
+// Helper: every tunable a replay must reproduce, by name. Plain fields are
+// registered by pointer; values behind the solver / smoke system setters
+// go through captureless getter/setter lambdas.
 //---------------------------------------------------------------------
-int main()
-{
-    // --- Window + context ---
-    glfwInit();
+static void registerTimelineParams(
+    InputTimeline& t,
+    SmokeSolver& solver,
+    ProceduralSmokeSystem& smokeSystem,
+    Raymarcher& raymarcher,
+    WorleyNoise& worleyNoise,
+    Compositor& compositor,
+    TemporalUpscaler& temporal,
+    EdgeRefinePass& edgeRefine,
+    DynamicResolution& dynamicRes,
+    int& raymarchResolutionMode) {
+    using S = SmokeSolver;
+    using P = ProceduralSmokeSystem;
+
+    // Solver
+    t.addParam("solver.pressureIterations", &solver.pressureIterations);
+    t.addParam("solver.advectSmoke",        &solver.advectSmokeEnabled);
+    t.addParam("solver.specialisedKernels", &solver.specialisedKernels);
+    t.addParam("solver.heatBuoyancyMode", &solver,
+               [](void* s) { return ((S*)s)->getUseHeatBuoyancy() ? 1.0f : 0.0f; },
+               [](void* s, float v) { ((S*)s)->setUseHeatBuoyancy(v != 0.0f); });
+    t.addParam("solver.heatBuoyancy", &solver,
+               [](void* s) { return ((S*)s)->getHeatBuoyancy(); },
+               [](void* s, float v) { ((S*)s)->setHeatBuoyancy(v); });
+    t.addParam("solver.buoyancy", &solver,
+               [](void* s) { return ((S*)s)->getBuoyancy(); },
+               [](void* s, float v) { ((S*)s)->setBuoyancy(v); });
+    t.addParam("solver.minSinkDensity", &solver,
+               [](void* s) { return ((S*)s)->getMinSinkDensity(); },
+               [](void* s, float v) { ((S*)s)->setMinSinkDensity(v); });
+    t.addParam("solver.maxSinkDensity", &solver,
+               [](void* s) { return ((S*)s)->getMaxSinkDensity(); },
+               [](void* s, float v) { ((S*)s)->setMaxSinkDensity(v); });
+    t.addParam("solver.gravity", &solver,
+               [](void* s) { return ((S*)s)->getGravity(); },
+               [](void* s, float v) { ((S*)s)->setGravity(v); });
+    t.addParam("solver.baroclinic", &solver,
+               [](void* s) { return ((S*)s)->getBaroClinicStrength(); },
+               [](void* s, float v) { ((S*)s)->setBaroClinicStrength(v); });
+    t.addParam("solver.fallOff", &solver,
+               [](void* s) { return ((S*)s)->getSmokeFallOff(); },
+               [](void* s, float v) { ((S*)s)->setSmokeFallOff(v); });
+    t.addParam("solver.diffusionRate", &solver,
+               [](void* s) { return ((S*)s)->getSmokeDiffusionRate(); },
+               [](void* s, float v) { ((S*)s)->setSmokeDiffsionRate(v); });
+
+    // Vacuum (activation itself is an action)
+    ApplyForces::VacuumState& vac = solver.vacuum();
+    t.addParam("vacuum.active",   &vac.active);
+    t.addParam("vacuum.duration", &vac.duration);
+    t.addParam("vacuum.strength", &vac.strength);
+    t.addParam("vacuum.radius",   &vac.radius);
+    t.addParam("vacuum.pressure", &vac.pressure);
+
+    // Smoke seeding
+    t.addParam("smoke.stepsPerFrame", &smokeSystem,
+               [](void* p) { return (float)((P*)p)->getFloodFillStepsPerFrame(); },
+               [](void* p, float v) { ((P*)p)->setFloodFillStepsPerFrame((int)v); });
+    t.addParam("smoke.seedDensity", &smokeSystem,
+               [](void* p) { return ((P*)p)->getFloodFillSmokeInjectStrength(); },
+               [](void* p, float v) { ((P*)p)->setFloodFillSmokeInjectStrength(v); });
+    t.addParam("smoke.seedVelocity", &smokeSystem,
+               [](void* p) { return ((P*)p)->getFloodFillVelocityInjectStrength(); },
+               [](void* p, float v) { ((P*)p)->setFloodFillVelocityInjectStrength(v); });
+    t.addParam("smoke.seedTemperature", &smokeSystem,
+               [](void* p) { return ((P*)p)->getFloodFillTempInjectStrength(); },
+               [](void* p, float v) { ((P*)p)->setFloodFillTempInjectStrength(v); });
+
+    // Raymarch + noise
+    t.addParam("raymarch.enabled",         &g_raymarchEnabled);
+    t.addParam("raymarch.resolutionMode",  &raymarchResolutionMode);
+    t.addParam("raymarch.resolutionScale", &raymarcher.resolutionScale);
+    t.addParam("raymarch.densityScale",    &raymarcher.densityScale);
+    t.addParam("raymarch.sigmaS",          &raymarcher.sigmaS);
+    t.addParam("raymarch.sigmaA",          &raymarcher.sigmaA);
+    t.addParam("raymarch.phaseBlend",      &raymarcher.phaseBlend);
+    t.addParam("raymarch.g",               &raymarcher.g);
+    t.addParam("raymarch.noiseStrength",   &raymarcher.noiseStrength);
+    t.addParam("raymarch.noiseScale",      &raymarcher.noiseScale);
+    t.addParam("raymarch.hazeFloor",       &raymarcher.hazeFloor);
+    t.addParam("raymarch.edgeFadeWidth",   &raymarcher.edgeFadeWidth);
+    t.addParam("raymarch.curlStrength",    &raymarcher.curlStrength);
+    t.addParam("raymarch.tileCulling",     &raymarcher.tileCulling);
+    t.addParam("raymarch.proxyBounds",     &raymarcher.proxyBounds);
+    t.addParam("noise.evolve",             &worleyNoise.evolve);
+    t.addParam("noise.slicesPerCycle",     &worleyNoise.slicesPerCycle);
+
+    // Post
+    t.addParam("dynamicRes.enabled",      &dynamicRes.enabled);
+    t.addParam("dynamicRes.budgetMs",     &dynamicRes.budgetMs);
+    t.addParam("compositor.sharpen",      &compositor.sharpenStrength);
+    t.addParam("compositor.fused",        &compositor.fused);
+    t.addParam("temporal.enabled",        &temporal.enabled);
+    t.addParam("temporal.freshWeight",    &temporal.freshWeight);
+    t.addParam("temporal.depthTolerance", &temporal.depthTolerance);
+    t.addParam("edgeRefine.enabled",      &edgeRefine.enabled);
+    t.addParam("edgeRefine.depthThreshold", &edgeRefine.depthThreshold);
+    t.addParam("edgeRefine.alphaThreshold", &edgeRefine.alphaThreshold);
+
+    // Light (position / colour / intensity travel as Light events) and views
+    t.addParam("light.orbit",      &g_light.orbitEnabled);
+    t.addParam("light.orbitSpeed", &g_light.orbitSpeed);
+    t.addParam("view.noise",       &g_noiseView.enabled);
+    t.addParam("view.velocity",    &g_velocityDebug.enabled);
+    t.addParam("view.depth",       &g_depthDebug.enabled);
+}
+
+static void setContextHints() {
 #ifdef __APPLE__
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
@@ -366,12 +551,48 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 #endif
-glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+}
 
-    // glfw window creation
-    // --------------------
-    GLFWwindow* window = glfwCreateWindow(winWidth, winHeight, "CS2 Volumetric Smoke", NULL, NULL);
+//---------------------------------------------------------------------
+// main
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    Headless::Options headless;
+    if (!Headless::parseArgs(argc, argv, headless)) return 2;
+
+    // A replay fixes the frame count and (headless) the resolution it was
+    // recorded with, so two builds run exactly the same workload.
+    if (!headless.replayPath.empty()) {
+        if (!g_timeline.loadReplay(headless.replayPath)) return 2;
+        headless.frames = (int)g_timeline.frames();
+        headless.dt     = g_timeline.dt();
+        if (g_timeline.frames() == 0) {
+            std::cerr << "[InputTimeline] Empty timeline\n";
+            return 2;
+        }
+        if (headless.enabled) {
+            headless.width  = (int)g_timeline.replayWidth();
+            headless.height = (int)g_timeline.replayHeight();
+        }
+    }
+
+    // --- Window + context ---
+    GLFWwindow* window = nullptr;
+    if (headless.enabled) {
+        winWidth  = (unsigned int)headless.width;
+        winHeight = (unsigned int)headless.height;
+        window = Headless::createWindow(winWidth, winHeight, "CS2 Volumetric Smoke", setContextHints);
+    } else {
+        glfwInit();
+        setContextHints();
+
+        // glfw window creation
+        // --------------------
+        window = glfwCreateWindow(winWidth, winHeight, "CS2 Volumetric Smoke", NULL, NULL);
+    }
     if (!window) {
         std::cout << "Failed to create GLFW window\n";
         glfwTerminate();
@@ -379,11 +600,16 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
     }
 
     glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetKeyCallback(window, key_callback);
-    glfwSetMouseButtonCallback(window, mouse_button_callback);
-    glfwSetCursorPosCallback(window, cursor_pos_callback);
-    glfwSetScrollCallback(window, scroll_callback);
+    if (!headless.enabled) {
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetKeyCallback(window, key_callback);
+        // A replay ignores the mouse: seeds, camera and light come from the file
+        if (!g_timeline.replaying()) {
+            glfwSetMouseButtonCallback(window, mouse_button_callback);
+            glfwSetCursorPosCallback(window, cursor_pos_callback);
+            glfwSetScrollCallback(window, scroll_callback);
+        }
+    }
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         std::cout << "Failed to initialize GLAD\n";
@@ -393,16 +619,39 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
     // --- Debug + GPU info ---
     enableGLDebug();
     printGPUInfo();
+    auto startupBegin = std::chrono::steady_clock::now();
+
+    // --- Shader builds: sources, binary cache, deferred checks (before the first shader) ---
+    if (headless.shaderDev) ShaderLibrary::instance().fromDisk = true;
+    if (headless.hotReload) ShaderReloader::instance().start("shaders");
+    ShaderManager::instance().deferred = !headless.serialShaders;
+    ShaderManager::instance().init((GLADloadproc)glfwGetProcAddress);
+    if (!headless.shaderCache.empty())
+        ProgramCache::instance().init(headless.shaderCache);
+    WorkgroupConfig::instance().load("workgroup_sizes.txt");
+
+    // --- Per-frame upload ring (persistently mapped) ---
+    FrameRingBuffer::instance().init();
 
     // --- Startup self-tests ---
     SelfTests::runAllTests();
 
     // --- ImGui init ---
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGui::StyleColorsDark();
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 430");
+    if (!headless.enabled) {
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGui::StyleColorsDark();
+        // A replay sets every parameter from the timeline, so the panel only
+        // shows them: no GLFW callbacks (keys, clicks, text) and no mouse.
+        const bool uiInput = !g_timeline.replaying();
+        ImGui_ImplGlfw_InitForOpenGL(window, uiInput);
+        if (!uiInput) {
+            ImGuiIO& io = ImGui::GetIO();
+            io.ConfigFlags |= ImGuiConfigFlags_NoMouse;
+            io.ConfigFlags &= ~ImGuiConfigFlags_NavEnableKeyboard;
+        }
+        ImGui_ImplOpenGL3_Init("#version 430");
+    }
 
     glEnable(GL_DEPTH_TEST);
 
@@ -418,11 +667,15 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
     g_noiseView.init();
     g_velocityDebug.init();
     g_depthDebug.init();
+#ifdef SMOKE_STATS
+    g_stepsHeatmap.init();
+    ShaderStats::instance().init(winWidth, winHeight);
+#endif
 
     // --- Voxel scene (procedural test arena) ---
     Voxelizer voxelizer;
     voxelizer.generateTestScene(0.15f, 96, 32, 96);
-    g_wallVoxelCache = voxelizer.staticVoxels.download<int>(voxelizer.domain.totalVoxels);
+    g_wallVoxelReadback.request(voxelizer.staticVoxels, voxelizer.domain.totalVoxels * sizeof(int));
 
     // pending arena settings for ImGUI (we ABSOLUTELY CANNOT allow a slider to constantly destroy and rebuild)
     float pendingVoxelSize = voxelizer.domain.voxelSize;
@@ -442,10 +695,25 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
     depthPass.init(winWidth, winHeight);
     g_depthPass = &depthPass;
 
+    // --- Linear min/max depth pyramid (raymarch, upsample, Hi-Z tiles) ---
+    DepthPyramid depthPyramid;
+    depthPyramid.init(winWidth, winHeight);
+
     // --- Raymarcher ---
     Raymarcher raymarcher;
     raymarcher.init(winWidth, winHeight);
-    int raymarchResolutionMode = 1; // 0=full, 1=half, 2=quarter
+    int raymarchResolutionMode = 1; // 0=full, 1=half, 2=quarter, 3=dynamic
+
+    // --- Temporal super-resolution (jittered low-res march -> full-res history) ---
+    TemporalUpscaler temporal;
+    temporal.init(winWidth, winHeight);
+
+    // --- Edge-adaptive refinement (full-res re-march of edge pixels) ---
+    EdgeRefinePass edgeRefine;
+    edgeRefine.init(winWidth, winHeight);
+
+    // --- Dynamic resolution (GPU-timed raymarch scale) ---
+    DynamicResolution dynamicRes;
 
     // --- Upsampler (Catmull-Rom bicubic) ---
     Upsampler upsampler;
@@ -462,6 +730,22 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
     Texture2D   sceneColorTex;
     rebuildSceneFBO(sceneFBO, sceneColorTex, depthPass.depthTex, (int)winWidth, (int)winHeight);
 
+    // Headless: the final image goes to an offscreen target instead of the
+    // window (a surfaceless context has no default framebuffer).
+    Framebuffer outputFBO;
+    Texture2D   outputTex;
+    if (headless.enabled) {
+        outputTex.create((int)winWidth, (int)winHeight, GL_RGBA8);
+        outputFBO.create();
+        outputFBO.attachColor(outputTex.ID);
+        if (!outputFBO.isComplete())
+            std::cerr << "[Headless] Output framebuffer incomplete\n";
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        compositor.targetFBO = outputFBO.ID;
+        if (!headless.dumpDir.empty() && !Headless::ensureDir(headless.dumpDir))
+            headless.dumpDir.clear();
+    }
+
     g_voxelizer = &voxelizer;
     g_floodFill = &floodFill;
 
@@ -477,20 +761,86 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
     ProceduralSmokeSystem smokeSystem;
     smokeSystem.init();
 
+    // --- Input timeline (record / replay) ---
+    registerTimelineParams(g_timeline, solver, smokeSystem, raymarcher, worleyNoise,
+                           compositor, temporal, edgeRefine, dynamicRes, raymarchResolutionMode);
+    g_timeline.attach(&g_camera, &g_light);
+    if (!headless.recordPath.empty())
+        g_timeline.startRecording(headless.recordPath, headless.dt, winWidth, winHeight);
+
+    {
+        ProgramCache& cache = ProgramCache::instance();
+        ShaderManager& shaders = ShaderManager::instance();
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - startupBegin).count();
+        std::cout << "[Startup] " << ms << " ms; programs: " << cache.hits << " from cache, "
+                  << shaders.submitted << " compiled ("
+                  << (shaders.deferred ? "deferred" : "serial") << " checks, "
+                  << shaders.waitMs << " ms blocked on them so far)\n";
+    }
+
     // --- Timing ---
+    // Headless, record and replay runs all step at a fixed dt.
+    const bool fixedStep = headless.enabled || g_timeline.mode() != InputTimeline::Mode::Off;
     float lastFrameTime = (float)glfwGetTime();
+    float fixedTime     = 0.0f;
+    uint32_t simFrame   = 0;
+    uint64_t lastProfiledFrame = 0;
+    bool autotuneRequested = headless.autotune;
+    bool raymarchAutotune  = false;   // set by the solver's; runs at the next raymarch
+
+    // Headless: same workload as "Throw Grenade", simulated at a fixed dt
+    // (a replay brings its own seeds).
+    int   headlessFrame = 0;
+    auto  headlessStart = std::chrono::steady_clock::now();
+    if (headless.enabled) {
+        if (!g_timeline.replaying()) {
+            glm::vec3 center = (voxelizer.domain.boundsMin + voxelizer.domain.boundsMax) * 0.5f;
+            floodFill.seed(center, voxelizer.domain.gridSize,
+                           voxelizer.domain.boundsMin, voxelizer.domain.voxelSize);
+            g_timeline.record(InputTimeline::Seed, &center.x, 3);
+        }
+        std::cout << "[Headless] Running " << headless.frames << " frames at "
+                  << winWidth << "x" << winHeight << ", dt " << headless.dt << " s\n";
+    }
 
     // --- Render loop ---
-    while (!glfwWindowShouldClose(window))
+    while (headless.enabled ? headlessFrame < headless.frames
+                            : !glfwWindowShouldClose(window) && !g_timeline.finished(simFrame))
     {
+        AllocCheck::instance().beginFrame();
+        FrameTrace::instance().beginFrame();
+        FrameRingBuffer::instance().beginFrame();
+        ShaderReloader::instance().beginFrame();   // edited shaders swap in from here on
+
         float time = (float)glfwGetTime();
         float dt   = time - lastFrameTime;
         lastFrameTime = time;
+        if (fixedStep) {
+            fixedTime += headless.dt;
+            time = fixedTime;
+            dt   = headless.dt;
+        }
 
-        glfwPollEvents();
-
-        // --- WASD camera movement ---
         {
+            CpuTraceScope trace("glfwPollEvents");
+            glfwPollEvents();
+        }
+
+        // Land any finished async readbacks
+        syncWallVoxelCache(false);
+        voxelizer.pollFilledCount();
+
+        GpuProfiler& profiler = GpuProfiler::instance();
+        profiler.beginFrame();
+        if (profiler.resolvedFrameIndex() != lastProfiledFrame) {
+            lastProfiledFrame = profiler.resolvedFrameIndex();
+            float raymarchMs;
+            if (profiler.latestMs("Raymarch", raymarchMs)) dynamicRes.update(raymarchMs);
+        }
+
+        // --- WASD camera movement (not during a replay) ---
+        if (!g_timeline.replaying()) {
             glm::vec3 camPos  = g_camera.position();
             glm::vec3 forward = glm::normalize(g_camera.target - camPos);
             glm::vec3 right   = glm::normalize(glm::cross(forward, g_camera.up));
@@ -507,13 +857,51 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
             if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) g_camera.target.y += speed;
         }
 
+        // --- Input timeline sync point: input for this frame is final ---
+        // Record captures changed camera / light / parameters; replay applies
+        // them and hands back this frame's actions.
+        {
+            InputTimeline::Event action;
+            while (g_timeline.sync(simFrame, action)) {
+                const glm::vec3 pos(action.v[0], action.v[1], action.v[2]);
+                switch (action.type) {
+                case InputTimeline::Seed:
+                    floodFill.seed(pos, voxelizer.domain.gridSize,
+                                   voxelizer.domain.boundsMin, voxelizer.domain.voxelSize);
+                    break;
+                case InputTimeline::Vacuum:
+                    solver.activateVacuum(pos);
+                    break;
+                case InputTimeline::Reset:
+                    floodFill.clear();
+                    smoke.clear();
+                    break;
+                case InputTimeline::Arena:
+                    pendingVoxelSize = action.v[0];
+                    pendingGridX = (int)action.v[1];
+                    pendingGridY = (int)action.v[2];
+                    pendingGridZ = (int)action.v[3];
+                    rebuildArena(voxelizer, floodFill, smoke, pendingVoxelSize,
+                                 pendingGridX, pendingGridY, pendingGridZ);
+                    break;
+                }
+            }
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, compositor.targetFBO);
         glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // Resize dependent resources when window size changes
         {
             depthPass.resize(winWidth, winHeight);
+            depthPyramid.resize(winWidth, winHeight);
             raymarcher.resize(winWidth, winHeight);
+            temporal.resize(winWidth, winHeight);
+            edgeRefine.resize(winWidth, winHeight);
+#ifdef SMOKE_STATS
+            ShaderStats::instance().resize(winWidth, winHeight);
+#endif
             upsampler.resize(winWidth, winHeight);
  
             // FIX: rebuild the scene FBO + texture together when the window
@@ -528,13 +916,24 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
         }
 
 
+#ifdef SMOKE_STATS
+        ShaderStats::instance().beginFrame();
+#endif
+
         // --- Camera matrices ---
         float aspect = (float)winWidth / (float)winHeight;
         glm::mat4 view = g_camera.view();
         glm::mat4 proj = g_camera.proj(aspect);
 
         // Render scene depth into FBO
-        depthPass.execute(voxelizer.staticVoxels, voxelizer.domain, view, proj);
+        {
+            GpuScope scope("Scene Depth");
+            depthPass.execute(voxelizer.staticVoxels, voxelizer.domain, view, proj);
+        }
+        {
+            GpuScope scope("Depth Pyramid");
+            depthPyramid.build(depthPass.depthTex, 0.001f, 100.0f);
+        }
 
         // Restore default viewport after depth pass
         glViewport(0, 0, winWidth, winHeight);
@@ -543,7 +942,24 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
         g_light.update(dt);
 
         // --- GPU simulation ---
-        worleyNoise.generate(time);
+        // The solver records its kernels into this graph; it executes below,
+        // after flood fill and injection, which still run immediately.
+        RenderGraph& graph = RenderGraph::instance();
+        if (autotuneRequested) {
+            autotuneRequested = false;
+            solver.autotune(smoke, voxelizer.staticVoxels, dt);
+            raymarchAutotune = true;
+        }
+        graph.begin();
+
+        // Static after init; only rebuilds a slab range when "Evolve Noise" is on.
+        // Independent of the sim, so it shares the first solver level. Nothing
+        // in the graph reads the noise, and generate() fences its own volume
+        // rotation, so it declares no resources.
+        if (worleyNoise.evolve) {
+            WorleyNoise* noise = &worleyNoise;
+            graph.addPass("Worley Noise").exec([noise] { noise->generate(); });
+        }
 
         // floodFill.propagate(12,
         //                     voxelizer.domain.gridSize,
@@ -561,20 +977,58 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
             voxelizer.domain,
             dt
         );
+        graph.execute();
 
-        // --- Ray march smoke into half-res texture ---
+        // --- Ray march smoke into reduced-res texture ---
+        bool refineActive = false;
         if (g_raymarchEnabled) {
-            raymarcher.render(
-                smoke.getSrcDensity(),
-                voxelizer.staticVoxels,
-                depthPass.depthTex,
-                worleyNoise.texture,
-                voxelizer.domain,
-                view, proj,
-                0.001f, 100.0f,
-                time,
-                g_light
-            );
+            if (dynamicRes.enabled) raymarcher.resolutionScale = dynamicRes.scale;
+
+            raymarcher.jitter = temporal.enabled ? temporal.nextJitter() : glm::vec2(0.0f);
+
+            if (raymarchAutotune) {
+                raymarchAutotune = false;
+                raymarcher.autotune(
+                    smoke.getSrcDensity(),
+                    voxelizer.staticVoxels,
+                    depthPyramid,
+                    worleyNoise,
+                    voxelizer.domain,
+                    view, proj,
+                    time,
+                    g_light
+                );
+            } else {
+                GpuScope scope("Raymarch");
+                raymarcher.render(
+                    smoke.getSrcDensity(),
+                    voxelizer.staticVoxels,
+                    depthPyramid,
+                    worleyNoise,
+                    voxelizer.domain,
+                    view, proj,
+                    time,
+                    g_light
+                );
+            }
+
+            if (temporal.enabled) {
+                GpuScope scope("Temporal Resolve");
+                temporal.resolve(raymarcher.smokeOut, raymarcher.renderW, raymarcher.renderH,
+                                 depthPyramid, view, proj);
+            }
+
+            // Spatial paths only: temporal output is already full-res.
+            refineActive = edgeRefine.enabled && !temporal.enabled &&
+                           (raymarcher.renderW != (int)winWidth || raymarcher.renderH != (int)winHeight);
+            if (refineActive) {
+                GpuScope scope("Edge Refine");
+                glm::ivec2 group = raymarcher.groupSize();
+                edgeRefine.detect(raymarcher.smokeOut, raymarcher.renderW, raymarcher.renderH, depthPyramid,
+                                  group.x * group.y);
+                raymarcher.refine(edgeRefine, smoke.getSrcDensity(), voxelizer.staticVoxels,
+                                  depthPyramid, worleyNoise);
+            }
         }
 
         // -------------------------------------------------------------------
@@ -613,12 +1067,12 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
                 g_light
             );
  
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glBindFramebuffer(GL_FRAMEBUFFER, compositor.targetFBO);
             glViewport(0, 0, (int)winWidth, (int)winHeight);
         }
         // -------------------------------------------------------------------
  
-        // --- Clear the default framebuffer for the final composite ---
+        // --- Clear the output framebuffer for the final composite ---
         glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
  
@@ -629,6 +1083,12 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
         else if (g_depthDebug.enabled) {
             g_depthDebug.draw(depthPass.depthTex, fsQuad);
         }
+#ifdef SMOKE_STATS
+        else if (g_stepsHeatmap.enabled) {
+            g_stepsHeatmap.draw(ShaderStats::instance().stepsImage,
+                                raymarcher.renderW, raymarcher.renderH, fsQuad);
+        }
+#endif
         else if (g_velocityDebug.enabled) {
             g_velocityDebug.draw(
                 voxelizer.domain, smoke.getSrcVelocity(),
@@ -640,12 +1100,28 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
             // - R ON  -> final composite: sceneColorTex (walls) + volumetric raymarched smoke
             // - R OFF -> voxel debug smoke cubes (yellow/orange)
             if (g_raymarchEnabled) {
-                if (raymarchResolutionMode == 0) {
+                // Temporal mode already resolved the smoke to full res.
+                const Texture2D& smokeTex = temporal.enabled ? temporal.output() : raymarcher.smokeOut;
+                int smokeW = temporal.enabled ? (int)winWidth  : raymarcher.renderW;
+                int smokeH = temporal.enabled ? (int)winHeight : raymarcher.renderH;
+                const EdgeRefinePass* refine = refineActive ? &edgeRefine : nullptr;
+
+                if (compositor.fused) {
+                    // One compute pass from the low-res smoke straight into the scene image
+                    GpuScope scope("Upsample + Composite");
+                    compositor.compositeFused(sceneColorTex, sceneFBO, smokeTex, smokeW, smokeH,
+                                              depthPyramid, depthPass.depthTex, refine);
+                } else if (smokeW == (int)winWidth && smokeH == (int)winHeight) {
                     // Full-res: no upsampler needed
-                    compositor.composite(sceneColorTex, raymarcher.smokeOut, depthPass.depthTex, fsQuad);
+                    GpuScope scope("Composite");
+                    compositor.composite(sceneColorTex, smokeTex, depthPass.depthTex, fsQuad);
                 } else {
-                    // Half/quarter-res: bilateral depth-aware upsample, then composite
-                    upsampler.upsample(raymarcher.smokeOut, depthPass.depthTex, fsQuad, raymarchResolutionMode, 0.001f, 100.0f);
+                    // Reduced res: bilateral depth-aware upsample, then composite
+                    {
+                        GpuScope scope("Upsample");
+                        upsampler.upsample(smokeTex, smokeW, smokeH, depthPyramid, fsQuad, refine);
+                    }
+                    GpuScope scope("Composite");
                     compositor.composite(sceneColorTex, upsampler.fullResOutput, depthPass.depthTex, fsQuad);
                 }
             } else {
@@ -664,7 +1140,49 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
         // Draw light marker on top of everything
         g_light.drawMarker(view, proj);
 
+#ifdef SMOKE_STATS
+        ShaderStats::instance().collect();
+#endif
+
+        // Everything from here to the swap, which the headless path also runs.
+        auto endFrame = [&] {
+            FrameRingBuffer::instance().endFrame();
+            RenderGraph::instance().endFrame();
+            if (headless.enabled) {
+                if (!headless.dumpDir.empty() && headlessFrame % headless.dumpEvery == 0) {
+                    AllocCheck::instance().exemptFrame();
+                    Headless::dumpPPM(outputFBO.ID, (int)winWidth, (int)winHeight,
+                                      Headless::framePath(headless.dumpDir, headlessFrame));
+                }
+                headlessFrame++;
+            } else {
+                CpuTraceScope trace("glfwSwapBuffers");
+                glfwSwapBuffers(window);
+            }
+
+            // Capture, CSV and timeline recording grow their event lists every
+            // frame; building a program (a new shader variant, a hot reload)
+            // allocates too.
+            static int lastBuilt = 0;
+            const ShaderReloader& reloader = ShaderReloader::instance();
+            const int built = ShaderManager::instance().submitted + ProgramCache::instance().hits +
+                              (int)reloader.generation() + reloader.reloaded + reloader.failed;
+            if (FrameTrace::instance().capturing() || GpuProfiler::instance().recording ||
+                g_timeline.recording() || built != lastBuilt)
+                AllocCheck::instance().exemptFrame();
+            lastBuilt = built;
+            AllocCheck::instance().endFrame();
+            simFrame++;
+        };
+
+        // No UI without a window.
+        if (headless.enabled) {
+            endFrame();
+            continue;
+        }
+
         // --- ImGui panel ---
+        FrameTrace::instance().cpuBegin("ImGui");
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -719,6 +1237,9 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
                     pendingGridY,
                     pendingGridZ
                 );
+                const float arena[4] = { pendingVoxelSize, (float)pendingGridX,
+                                         (float)pendingGridY, (float)pendingGridZ };
+                g_timeline.record(InputTimeline::Arena, arena, 4);
             }
 
             if (!changed)
@@ -733,17 +1254,26 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
                 glm::vec3 center = (voxelizer.domain.boundsMin + voxelizer.domain.boundsMax) * 0.5f;
                 floodFill.seed(center, voxelizer.domain.gridSize,
                                voxelizer.domain.boundsMin, voxelizer.domain.voxelSize);
+                g_timeline.record(InputTimeline::Seed, &center.x, 3);
             }
             ImGui::SameLine();
             if (ImGui::Button("Reset")) {
                 floodFill.clear();
                 smoke.clear();
+                g_timeline.record(InputTimeline::Reset);
             }
             ImGui::TextDisabled("Default seed is at center of the scene. Right-click on surfaces to seed.");
             static int expansionSpeed = 1;
             if (ImGui::SliderInt("Expansion Speed", &expansionSpeed, 1, 8))
                 smokeSystem.setFloodFillStepsPerFrame(expansionSpeed);
             ImGui::Checkbox("Advect Smoke", &solver.advectSmokeEnabled);
+            ImGui::Checkbox("Specialised Kernels", &solver.specialisedKernels);
+            ImGui::SameLine();
+            if (ImGui::Button("Autotune Workgroups")) autotuneRequested = true;
+            const ShaderReloader& reloader = ShaderReloader::instance();
+            if (reloader.enabled())
+                ImGui::TextDisabled("Hot reload: %d kernel(s) swapped, %d failed",
+                                    reloader.reloaded, reloader.failed);
         }
 
         // --- Light ---
@@ -901,31 +1431,109 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
             ImGui::SliderFloat("Haze Floor",     &raymarcher.hazeFloor,     0.0f, 1.0f);
             ImGui::SliderFloat("Edge Fade Width",&raymarcher.edgeFadeWidth, 0.05f, 0.6f);
             ImGui::SliderFloat("Curl Strength",  &raymarcher.curlStrength,  0.0f, 4.0f);
+
+            ImGui::Checkbox("Evolve Noise", &worleyNoise.evolve);
+            if (worleyNoise.evolve)
+                ImGui::SliderInt("Frames per Rebuild", &worleyNoise.slicesPerCycle, 1, 128);
         }
 
+#ifdef SMOKE_STATS
+        // --- Shader hot-path counters ---
+        if (ImGui::CollapsingHeader("Shader Stats")) {
+            const GLuint* c = ShaderStats::instance().counters;
+            GLuint rays = c[ShaderStats::RaysMarched];
+            GLuint fine = c[ShaderStats::FineSteps];
+            ImGui::Text("Rays marched:      %u", rays);
+            ImGui::Text("Fine steps / ray:  %.1f (max %u)",
+                        rays ? (float)fine / rays : 0.0f, c[ShaderStats::MaxRaySteps]);
+            ImGui::Text("Shadow samples / step: %.2f",
+                        fine ? (float)c[ShaderStats::ShadowSamples] / fine : 0.0f);
+            ImGui::Text("Early terminated:  %u (%.0f%%)", c[ShaderStats::EarlyTerminated],
+                        rays ? 100.0f * c[ShaderStats::EarlyTerminated] / rays : 0.0f);
+            ImGui::Text("Wall voxels skipped: %u", c[ShaderStats::WallVoxelsSkipped]);
+            ImGui::Checkbox("Steps Heatmap (H)", &g_stepsHeatmap.enabled);
+            ImGui::SliderInt("Heatmap Max Steps", &g_stepsHeatmap.maxSteps, 16, 1024);
+        }
+#endif
+
         // --- Post-Processing (Sharpening & Compositing) ---
         if (ImGui::CollapsingHeader("Post-Processing", ImGuiTreeNodeFlags_DefaultOpen)) {
             const char* resItems[] = {
                 "1.0x (Full)",
                 "0.5x (Half)",
-                "0.25x (Quarter)"
+                "0.25x (Quarter)",
+                "Dynamic"
             };
+            // Scale changes only move the raymarch viewport; nothing is reallocated.
             if (ImGui::Combo("Raymarch Resolution", &raymarchResolutionMode, resItems, IM_ARRAYSIZE(resItems))) {
                 if (raymarchResolutionMode == 0) raymarcher.resolutionScale = 1.0f;
                 if (raymarchResolutionMode == 1) raymarcher.resolutionScale = 0.5f;
                 if (raymarchResolutionMode == 2) raymarcher.resolutionScale = 0.25f;
-                raymarcher.resize(winWidth, winHeight);
+                dynamicRes.enabled = (raymarchResolutionMode == 3);
+                if (dynamicRes.enabled) dynamicRes.scale = raymarcher.resolutionScale;
+            }
+            if (dynamicRes.enabled) {
+                ImGui::SliderFloat("Raymarch Budget (ms)", &dynamicRes.budgetMs, 0.5f, 16.0f);
+                ImGui::Text("Raymarch GPU: %.2f ms  scale %.2f (%dx%d)",
+                            dynamicRes.lastGpuMs, dynamicRes.scale,
+                            raymarcher.renderW, raymarcher.renderH);
+                if (!GpuProfiler::instance().enabled)
+                    ImGui::TextDisabled("Needs the GPU profiler (P) enabled");
             }
 
             ImGui::SliderFloat("Sharpen Strength", &compositor.sharpenStrength, 0.0f, 2.0f);
+            ImGui::Checkbox("Fused Upsample + Composite", &compositor.fused);
+            if (ImGui::Checkbox("Temporal Upscale", &temporal.enabled)) {
+                temporal.reset();
+                // Designed around a quarter-res march; any scale still works.
+                if (temporal.enabled && raymarchResolutionMode != 3) {
+                    raymarchResolutionMode = 2;
+                    raymarcher.resolutionScale = 0.25f;
+                }
+            }
+            ImGui::Checkbox("Edge Refine (full-res re-march)", &edgeRefine.enabled);
+            if (edgeRefine.enabled) {
+                ImGui::SliderFloat("Edge Depth Threshold", &edgeRefine.depthThreshold, 0.005f, 0.5f);
+                ImGui::SliderFloat("Edge Alpha Threshold", &edgeRefine.alphaThreshold, 0.01f, 0.5f);
+            }
+            if (temporal.enabled) {
+                ImGui::SliderFloat("Temporal Fresh Weight", &temporal.freshWeight,    0.05f, 1.0f);
+                ImGui::SliderFloat("Disocclusion Tolerance", &temporal.depthTolerance, 0.005f, 0.2f);
+            }
+            ImGui::Checkbox("Tile Culling", &raymarcher.tileCulling);
+            ImGui::SameLine();
+            ImGui::Checkbox("Proxy Ray Bounds", &raymarcher.proxyBounds);
+
+            RenderGraph& rg = RenderGraph::instance();
+            ImGui::Checkbox("Graph: Full Barriers (debug)", &rg.fullBarriers);
+            ImGui::SameLine();
+            ImGui::TextDisabled("%d passes, %d barriers", rg.lastPassCount(), rg.lastBarrierCount());
         }
 
         ImGui::End();
 
+        g_profilerOverlay.draw();
+
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        FrameTrace::instance().cpuEnd();
 
-        glfwSwapBuffers(window);
+        endFrame();
+    }
+
+    g_timeline.save(simFrame);
+
+    if (headless.enabled) {
+        glFinish();
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - headlessStart).count();
+        std::cout << "[Headless] " << headlessFrame << " frames in " << seconds << " s ("
+                  << seconds * 1000.0 / std::max(headlessFrame, 1) << " ms/frame)\n";
+        std::cout << "[Headless] GPU ms per pass (avg over its last frames, at most "
+                  << GpuProfiler::HISTORY << "):\n";
+        for (const GpuProfiler::PassStats& s : GpuProfiler::instance().stats())
+            std::cout << "  " << s.name << ": " << s.avgMs << " (" << s.historyCount
+                      << " frames)\n";
     }
 
     // --- Cleanup ---
@@ -936,10 +1544,19 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
 
     g_light.destroyMarker();
     depthPass.destroy();
+    depthPyramid.destroy();
     raymarcher.destroy();
+    GpuProfiler::instance().destroy();
+    FrameTrace::instance().destroy();
+    FrameRingBuffer::instance().destroy();
+    RenderGraph::instance().destroy();
+    temporal.destroy();
+    edgeRefine.destroy();
     upsampler.destroy();
     compositor.destroy();
     sceneColorTex.destroy();
+    outputTex.destroy();
+    outputFBO.destroy();
     solver.destroy();
     smoke.destroy();
     smokeSystem.destroy();
@@ -952,11 +1569,18 @@ glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
     g_noiseView.destroy();
     g_velocityDebug.destroy();
     g_depthDebug.destroy();
+    g_wallVoxelReadback.destroy();
+#ifdef SMOKE_STATS
+    g_stepsHeatmap.destroy();
+    ShaderStats::instance().destroy();
+#endif
 
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
+    if (!headless.enabled) {
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+    }
 
     glfwTerminate();
-    return 0;
+    return AllocCheck::instance().report() ? 0 : 1;
 }
\ No newline at end of file
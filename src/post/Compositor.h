@@ -3,9 +3,14 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <iostream>
+#include <algorithm>
 #include "core/Texture2D.h"
+#include "core/Framebuffer.h"
+#include "core/ComputeShader.h"
 #include "core/shader.h"
 #include "core/FullscreenQuad.h"
+#include "Rendering/DepthPyramid.h"
+#include "Rendering/EdgeRefinePass.h"
 #include "glVersion.h"
 
 class Compositor {
@@ -20,9 +25,18 @@ public:
     
     float sharpenStrength = 0.5f;
     int debugMode = DEBUG_FINAL;
+
+    // Use compositeFused() (one compute dispatch straight from the low-res
+    // smoke) instead of Upsampler + composite().
+    bool fused = true;
+
+    // Framebuffer that receives the final image: 0 = the window, or an
+    // offscreen FBO of the same size (headless runs).
+    GLuint targetFBO = 0;
     
     void init() {
         buildCompositeShader();
+        fusedCS.setUpFromFile("shaders/smoke/UpsampleComposite.comp");
     }
     
     // Composite smoke over scene with optional sharpening.
@@ -41,7 +55,7 @@ public:
                    const Texture2D& smokeTex,
                    const Texture2D& depthTex,
                    FullscreenQuad& quad) {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
         glViewport(0, 0, smokeTex.width, smokeTex.height);
 
         compositeShader.use();
@@ -65,15 +79,65 @@ public:
         glEnable(GL_DEPTH_TEST);
     }
     
+    // Upsample + sharpen + composite in a single compute dispatch.
+    // The result is written into sceneColorTex in place (each thread only
+    // touches its own scene pixel), then sceneFBO is blitted to targetFBO. No intermediate full-res smoke target is needed.
+    // smokeTex:  raymarch output, valid in [0, smokeW) x [0, smokeH)
+    // depthTex:  raw scene depth for the depth debug mode
+    // refine:    optional full-res re-marched edge pixels, used where flagged
+    void compositeFused(const Texture2D&      sceneColorTex,
+                        const Framebuffer&    sceneFBO,
+                        const Texture2D&      smokeTex,
+                        int smokeW, int smokeH,
+                        const DepthPyramid&   depthPyramid,
+                        const Texture2D&      depthTex,
+                        const EdgeRefinePass* refine = nullptr) {
+        int outW = sceneColorTex.width;
+        int outH = sceneColorTex.height;
+        float ratio = std::min((float)smokeW / outW, (float)smokeH / outH);
+
+        sceneColorTex.bindImage(0, GL_READ_WRITE);
+        smokeTex.bindSampler(0);
+        depthPyramid.tex.bindSampler(1);
+        depthTex.bindSampler(2);
+        if (refine) {
+            refine->refined.bindSampler(3);
+            refine->edgeFlags.bindSampler(4);
+        }
+
+        fusedCS.use();
+        fusedCS.setInt  ("u_SmokeTex",        0);
+        fusedCS.setInt  ("u_DepthPyramid",    1);
+        fusedCS.setInt  ("u_DepthTex",        2);
+        fusedCS.setInt  ("u_SmokeLevel",      depthPyramid.levelForScale(ratio));
+        fusedCS.setFloat("u_SharpenStrength", sharpenStrength);
+        fusedCS.setInt  ("u_DebugMode",       debugMode);
+        fusedCS.setInt  ("u_RefinedTex",      3);
+        fusedCS.setInt  ("u_EdgeFlags",       4);
+        fusedCS.setInt  ("u_UseRefine",       refine ? 1 : 0);
+        glUniform2i(glGetUniformLocation(fusedCS.ID, "u_SmokeSize"), smokeW, smokeH);
+        glUniform2i(glGetUniformLocation(fusedCS.ID, "u_OutSize"),   outW,   outH);
+        fusedCS.dispatch(outW, outH, 1);
+        glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFBO.ID);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFBO);
+        glBlitFramebuffer(0, 0, outW, outH, 0, 0, outW, outH, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
     void destroy() {
         if (compositeShader.ID) {
             glDeleteProgram(compositeShader.ID);
             compositeShader.ID = 0;
         }
+        if (fusedCS.ID) { glDeleteProgram(fusedCS.ID); fusedCS.ID = 0; }
     }
     
 private:
-    shader compositeShader;
+    shader        compositeShader;
+    ComputeShader fusedCS;
     
     void buildCompositeShader() {
         const char* vs = GLSL_VERSION
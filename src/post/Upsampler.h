@@ -3,10 +3,16 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <iostream>
+#include <algorithm>
+#include <string>
 #include "core/Texture2D.h"
 #include "core/Framebuffer.h"
 #include "core/shader.h"
 #include "core/FullscreenQuad.h"
+#include "core/RenderGraph.h"
+#include "core/ShaderLibrary.h"
+#include "Rendering/DepthPyramid.h"
+#include "Rendering/EdgeRefinePass.h"
 #include "glVersion.h"
 
 // Bilateral (depth-aware) upsampler.
@@ -15,10 +21,20 @@
 // neighbor is weighted by exp(-|depth_center - depth_neighbor| * sigma) so that
 // samples across a depth discontinuity (e.g. smoke behind a wall) are rejected.
 // This prevents smoke color/transmittance from bleeding across wall edges at
-// half-res or quarter-res.
+// reduced raymarch resolution.
 //
-// Quarter-res chains two bilateral passes (Q->half, half->full) to limit the
-// upscale ratio per pass, matching Acerola's approach.
+// Depths come from the DepthPyramid: every pixel, input or output, uses the
+// farthest depth under its footprint, which is exactly where the raymarcher
+// clipped it. The input may be any sub-rect of its texture at any ratio to the
+// output (DynamicResolution), not just 1/2 or 1/4.
+//
+// With an EdgeRefinePass, the final pass takes the full-res re-marched value
+// for flagged edge pixels instead of filtering.
+//
+// Ratios below 1/2 chain two bilateral passes (low->half, half->full) to limit
+// the upscale ratio per pass, matching Acerola's approach. The half-res
+// intermediate only lives for those two passes, so it comes from the
+// RenderGraph transient pool instead of being held all frame.
 class Upsampler {
 public:
     Texture2D fullResOutput;
@@ -27,16 +43,14 @@ public:
         fullW = fullWidth;
         fullH = fullHeight;
 
-        fullResOutput.create(fullW,     fullH,     GL_RGBA16F);
-        halfTex      .create(fullW / 2, fullH / 2, GL_RGBA16F);
+        fullResOutput.create(fullW, fullH, GL_RGBA16F);
 
         buildBilateralShader();
 
         outputFBO.create(); outputFBO.attachColor(fullResOutput.ID);
-        halfFBO  .create(); halfFBO  .attachColor(halfTex.ID);
+        halfFBO  .create();   // colour attached on first use (transient texture)
 
         if (!outputFBO.isComplete()) std::cerr << "Upsampler output FBO incomplete!\n";
-        if (!halfFBO  .isComplete()) std::cerr << "Upsampler half FBO incomplete!\n";
     }
 
     void resize(int fullWidth, int fullHeight) {
@@ -45,44 +59,59 @@ public:
         fullH = fullHeight;
 
         fullResOutput.destroy(); outputFBO.destroy();
-        halfTex      .destroy(); halfFBO  .destroy();
+        detachHalf();   // the old size's texture
 
-        fullResOutput.create(fullW,     fullH,     GL_RGBA16F);
-        halfTex      .create(fullW / 2, fullH / 2, GL_RGBA16F);
+        fullResOutput.create(fullW, fullH, GL_RGBA16F);
 
         outputFBO.create(); outputFBO.attachColor(fullResOutput.ID);
-        halfFBO  .create(); halfFBO  .attachColor(halfTex.ID);
     }
 
-    // resMode: 1 = half-res input, 2 = quarter-res input.
-    // depthTex: full-res scene depth (GL_DEPTH_COMPONENT or R-format depth copy).
-    // zNear/zFar: camera clip planes, used to linearise depth for bilateral weighting.
-    void upsample(const Texture2D& lowResSmoke,
-                  const Texture2D& depthTex,
-                  FullscreenQuad&  quad,
-                  int   resMode,
-                  float zNear,
-                  float zFar)
+    // lowResSmoke: raymarch output; only [0, srcW) x [0, srcH) is valid.
+    // depthPyramid: linear min/max depth, built this frame from the scene depth.
+    // refine: optional full-res re-marched edge pixels.
+    void upsample(const Texture2D&      lowResSmoke,
+                  int srcW, int srcH,
+                  const DepthPyramid&   depthPyramid,
+                  FullscreenQuad&       quad,
+                  const EdgeRefinePass* refine = nullptr)
     {
         glDisable(GL_DEPTH_TEST);
         bilateralShader.use();
-        bilateralShader.setInt  ("u_Tex",      0);
-        bilateralShader.setInt  ("u_DepthTex", 1);
-        bilateralShader.setFloat("u_Near",     zNear);
-        bilateralShader.setFloat("u_Far",      zFar);
-
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, depthTex.ID);
+        bilateralShader.setInt("u_Tex",          0);
+        bilateralShader.setInt("u_DepthPyramid", 1);
+        bilateralShader.setInt("u_RefinedTex",   2);
+        bilateralShader.setInt("u_EdgeFlags",    3);
+
+        depthPyramid.tex.bindSampler(1);
+        if (refine) {
+            refine->refined.bindSampler(2);
+            refine->edgeFlags.bindSampler(3);
+        }
         glActiveTexture(GL_TEXTURE0);
 
-        if (resMode == 2) {
-            // Pass 1: quarter -> half
-            bilateralBlit(lowResSmoke, halfFBO,   fullW / 2, fullH / 2, quad);
+        float ratio = std::min((float)srcW / fullW, (float)srcH / fullH);
+        int   srcLevel = depthPyramid.levelForScale(ratio);
+
+        if (ratio < 0.5f) {
+            RenderGraph::TransientTextures& pool = RenderGraph::instance().transients;
+            const Texture2D& halfTex = pool.acquire(fullW / 2, fullH / 2, GL_RGBA16F);
+            if (halfTex.ID != halfAttached || pool.allocations() != halfAllocations) {
+                halfFBO.attachColor(halfTex.ID);
+                halfAttached    = halfTex.ID;
+                halfAllocations = pool.allocations();
+            }
+            // Pass 1: low -> half
+            bilateralBlit(lowResSmoke, srcW, srcH, srcLevel,
+                          halfFBO, halfTex.width, halfTex.height, 1, false, quad);
             // Pass 2: half -> full
-            bilateralBlit(halfTex,     outputFBO, fullW,     fullH,     quad);
+            bilateralBlit(halfTex, halfTex.width, halfTex.height, 1,
+                          outputFBO, fullW, fullH, 0, refine != nullptr, quad);
+            pool.release(halfTex);
         } else {
-            // Half -> full, single pass
-            bilateralBlit(lowResSmoke, outputFBO, fullW, fullH, quad);
+            detachHalf();   // let the pool trim it
+            // Single pass
+            bilateralBlit(lowResSmoke, srcW, srcH, srcLevel,
+                          outputFBO, fullW, fullH, 0, refine != nullptr, quad);
         }
 
         glEnable(GL_DEPTH_TEST);
@@ -91,24 +120,38 @@ public:
 
     void destroy() {
         fullResOutput.destroy();
-        halfTex      .destroy();
         outputFBO    .destroy();
         halfFBO      .destroy();
+        halfAttached = 0;
         if (bilateralShader.ID) { glDeleteProgram(bilateralShader.ID); bilateralShader.ID = 0; }
     }
 
 private:
     shader      bilateralShader;
     Framebuffer outputFBO;
-    Framebuffer halfFBO;
-    Texture2D   halfTex;   // RGBA16F ping-pong for quarter-res pass 1
+    Framebuffer halfFBO;   // low->half target; transient RGBA16F
+    GLuint      halfAttached    = 0;   // texture attached to halfFBO
+    uint64_t    halfAllocations = 0;   // pool allocations() when it was attached
     int fullW = 0, fullH = 0;
 
-    void bilateralBlit(const Texture2D& src, Framebuffer& dstFBO, int dstW, int dstH, FullscreenQuad& quad) {
+    // An attached texture the pool deletes would stay alive through the FBO.
+    void detachHalf() {
+        if (!halfAttached) return;
+        halfFBO.attachColor(0);
+        halfAttached = 0;
+    }
+
+    void bilateralBlit(const Texture2D& src, int srcW, int srcH, int srcLevel,
+                       Framebuffer& dstFBO, int dstW, int dstH, int dstLevel,
+                       bool useRefine, FullscreenQuad& quad) {
         dstFBO.bind();
         glViewport(0, 0, dstW, dstH);
         glClear(GL_COLOR_BUFFER_BIT);
-        glUniform2i(glGetUniformLocation(bilateralShader.ID, "u_TexSize"), src.width, src.height);
+        glUniform2i(glGetUniformLocation(bilateralShader.ID, "u_TexSize"), srcW, srcH);
+        glUniform2i(glGetUniformLocation(bilateralShader.ID, "u_DstSize"), dstW, dstH);
+        bilateralShader.setInt("u_SrcLevel", srcLevel);
+        bilateralShader.setInt("u_DstLevel", dstLevel);
+        bilateralShader.setInt("u_UseRefine", useRefine ? 1 : 0);
         glBindTexture(GL_TEXTURE_2D, src.ID);
         quad.draw();
     }
@@ -122,71 +165,10 @@ private:
             "    texCoord = aPos * 0.5 + 0.5;\n"
             "}\n";
 
-        // Bilateral 2x2 bilinear upsample.
-        //
-        // For each full-res output pixel:
-        //   1. Read scene depth and linearise it.
-        //   2. Iterate the 2x2 low-res neighbourhood.
-        //   3. For each neighbour, read the scene depth at that position.
-        //   4. Weight = bilinear_weight * exp(-|depth_diff| * sigma).
-        //      Neighbours across a depth discontinuity (wall edge) get near-zero weight.
-        //   5. Normalise. Fallback to nearest-neighbour if all weights collapse.
-        //
-        // Result: smoke colour + transmittance alpha are depth-correct at wall edges
-        // — no bleeding of smoke across geometry boundaries.
-        const char* fs = GLSL_VERSION
-            "in vec2 texCoord;\n"
-            "out vec4 fragColor;\n"
-            "uniform sampler2D u_Tex;\n"
-            "uniform sampler2D u_DepthTex;\n"
-            "uniform ivec2     u_TexSize;\n"
-            "uniform float     u_Near;\n"
-            "uniform float     u_Far;\n"
-            "\n"
-            "float linearize(float d) {\n"
-            "    float z = d * 2.0 - 1.0;\n"
-            "    return (2.0 * u_Near * u_Far) / (u_Far + u_Near - z * (u_Far - u_Near));\n"
-            "}\n"
-            "\n"
-            "void main() {\n"
-            "    float centerDepth = linearize(texture(u_DepthTex, texCoord).r);\n"
-            "\n"
-            "    vec2  texSize  = vec2(u_TexSize);\n"
-            "    vec2  pixelPos = texCoord * texSize - 0.5;\n"
-            "    ivec2 base     = ivec2(floor(pixelPos));\n"
-            "    vec2  f        = fract(pixelPos);\n"
-            "\n"
-            "    vec4  result   = vec4(0.0);\n"
-            "    float totalW   = 0.0;\n"
-            "\n"
-            "    for (int dy = 0; dy <= 1; dy++) {\n"
-            "        for (int dx = 0; dx <= 1; dx++) {\n"
-            "            ivec2 texel = clamp(base + ivec2(dx, dy), ivec2(0), u_TexSize - 1);\n"
-            "            vec2  uv    = (vec2(texel) + 0.5) / texSize;\n"
-            "\n"
-            "            float nDepth = linearize(texture(u_DepthTex, uv).r);\n"
-            "            float depthW = exp(-abs(centerDepth - nDepth) * 100.0);\n"
-            "\n"
-            "            float bx = (dx == 0) ? (1.0 - f.x) : f.x;\n"
-            "            float by = (dy == 0) ? (1.0 - f.y) : f.y;\n"
-            "            float w  = bx * by * depthW;\n"
-            "\n"
-            "            result += texture(u_Tex, uv) * w;\n"
-            "            totalW += w;\n"
-            "        }\n"
-            "    }\n"
-            "\n"
-            "    if (totalW < 1e-5) {\n"
-            "        // All neighbours on the other side of a depth edge — use nearest.\n"
-            "        ivec2 nearest = clamp(ivec2(round(pixelPos)), ivec2(0), u_TexSize - 1);\n"
-            "        result = texture(u_Tex, (vec2(nearest) + 0.5) / texSize);\n"
-            "    } else {\n"
-            "        result /= totalW;\n"
-            "    }\n"
-            "\n"
-            "    result.a = clamp(result.a, 0.0, 1.0);\n"
-            "    fragColor = result;\n"
-            "}\n";
+        // Bilateral 2x2 bilinear upsample: shaders/smoke/BilateralUpsample.frag.
+        std::string fsSource = std::string(GLSL_VERSION) +
+            ShaderLibrary::instance().load("shaders/smoke/BilateralUpsample.frag");
+        const char* fs = fsSource.c_str();
 
         GLint ok;
         uint32_t vsID = glCreateShader(GL_VERTEX_SHADER);